@@ -1,34 +1,58 @@
-
-#ifndef __ALIGNPARAMS_H
-#define __ALIGNPARAMS_H
-
-
-struct AlignParams {
-	AlignParams();
-
-	double lambda;
-	int heuristic_start;
-	bool branch_and_bound;
-	bool sequential_order;
-	bool annealing;
-	double annealing_initial;
-	double annealing_rate;
-	string weight_method;
-	int fragment_length;
-};
-
-inline AlignParams::AlignParams()
-{
-	lambda = 6.0;
-	heuristic_start = 0;
-	branch_and_bound = false;
-	sequential_order = false;
-	annealing = false;
-	annealing_initial = 60.0;
-	annealing_rate = 0.4;
-	weight_method = "LS";
-	fragment_length = 8;
-}
-
-
+
+#ifndef __ALIGNPARAMS_H
+#define __ALIGNPARAMS_H
+
+
+struct AlignParams {
+	AlignParams();
+
+	double lambda;
+	int heuristic_start;
+	bool branch_and_bound;
+	bool sequential_order;
+	bool annealing;
+	double annealing_initial;
+	double annealing_rate;
+	string weight_method;
+	int fragment_length;
+	int thread_num;
+	string priority_queue;
+	bool warm_start;
+	bool single_precision;
+	bool validate;
+	int align_memory;
+	int band_width;
+	double time_limit;
+	int race_rounds;
+	int race_survivors;
+	string seed_method;
+	int seed_budget;
+};
+
+inline AlignParams::AlignParams()
+{
+	lambda = 6.0;
+	heuristic_start = 0;
+	branch_and_bound = false;
+	sequential_order = false;
+	annealing = false;
+	annealing_initial = 60.0;
+	annealing_rate = 0.4;
+	weight_method = "LS";
+	fragment_length = 8;
+	thread_num = 1;
+	priority_queue = "dary";
+	warm_start = true;
+	single_precision = false;
+	validate = false;
+	align_memory = 512;
+	band_width = 0;
+	time_limit = 0;
+	race_rounds = 0;
+	race_survivors = 1;
+	seed_method = "grid";
+	seed_budget = 8;
+}
+
+
 #endif // __ALIGNPARAMS_H
\ No newline at end of file
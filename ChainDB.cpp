@@ -0,0 +1,192 @@
+
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+#include "ChainDB.h"
+
+#include "MemLeak.h"
+
+
+static const char chain_db_magic[8] = { 'S', 'A', 'M', 'O', 'C', 'D', 'B', 2 };
+
+
+////////////////////////////////
+//
+// class ChainDB
+
+bool ChainDB::open(const string &filename)
+{
+	const ChainDBHeader *header;
+	const ChainDBIndex *index;
+	int i;
+
+	close();
+	m_filename = filename;
+	if (!m_file.open(filename.c_str())) return false;
+	header = (const ChainDBHeader *) m_file.data();
+	if (m_file.size() < sizeof(ChainDBHeader)
+		|| memcmp(header->magic, chain_db_magic, sizeof(chain_db_magic)) != 0
+		|| header->num_chains < 0
+		|| header->index_offset % 8 != 0
+		|| header->index_offset > m_file.size()
+		|| (boost::uint64_t) header->num_chains > (m_file.size() - header->index_offset) / sizeof(ChainDBIndex)) {
+		m_file.close();
+		return false;
+	}
+	index = (const ChainDBIndex *) (m_file.data() + header->index_offset);
+	for (i=0; i<header->num_chains; i++) {
+		if (memchr(index[i].name, 0, sizeof(index[i].name)) == NULL) break;
+	}
+	if (i < header->num_chains) {
+		m_file.close();
+		return false;
+	}
+	m_header = header;
+	m_index = index;
+	Logger::verbose("Chain database %s has %d chains", filename.c_str(), size());
+	return true;
+}
+
+void ChainDB::close()
+{
+	m_file.close();
+	m_header = NULL;
+	m_index = NULL;
+}
+
+// the chain of a code by its identifier, or the chain_index-th chain of the code
+// in its PDB file if the identifier is 0 as PDB::getChainID, -1 if there is none
+
+int ChainDB::find(const string &code, char chain_id, int chain_index) const
+{
+	ChainDBIndex key;
+	const ChainDBIndex *p, *end;
+	string name;
+
+	if (m_index == NULL) return -1;
+	name = getName(code, chain_id);
+	memset(key.name, 0, sizeof(key.name));
+	memcpy(key.name, name.data(), name.size());
+	end = m_index + size();
+	p = lower_bound(m_index, end, key, _lessName);
+	if (chain_id != 0) {
+		if (p != end && strcmp(p->name, key.name) == 0) return p - m_index;
+		return -1;
+	}
+	for (; p != end && strncmp(p->name, key.name, name.size()) == 0; ++p) {
+		if (strlen(p->name) == name.size() + 1 && p->chain_index == max(chain_index, 1)) return p - m_index;
+	}
+	return -1;
+}
+
+void ChainDB::getChain(int i, ProteinChain &chain) const
+{
+	const ChainDBRecord *record;
+	boost::uint64_t offset;
+
+	// records are written 8-byte aligned, so any other offset is corrupt and
+	// is checked before it is cast
+	offset = m_index[i].offset;
+	if (offset % 8 != 0 || offset > m_file.size() || m_file.size() - offset < sizeof(ChainDBRecord)) {
+		Logger::error("Invalid record of chain %s in the chain database %s!", m_index[i].name, filename());
+		exit(1);
+	}
+	record = (const ChainDBRecord *) (m_file.data() + offset);
+	if (record->length < 0
+		|| (boost::uint64_t) record->length > (m_file.size() - offset - sizeof(ChainDBRecord)) / 23
+		|| memchr(record->id_code, 0, sizeof(record->id_code)) == NULL
+		|| memchr(record->dep_date, 0, sizeof(record->dep_date)) == NULL
+		|| memchr(record->classification, 0, sizeof(record->classification)) == NULL) {
+		Logger::error("Invalid record of chain %s in the chain database %s!", m_index[i].name, filename());
+		exit(1);
+	}
+	chain.getChain(*record);
+}
+
+// write the chains as records in their order, then the index, and the header
+// last as the index offset is known only then
+
+void ChainDB::writeFile(const string &filename, const vector<ProteinChain> &chains)
+{
+	ChainDBHeader header;
+	ChainDBIndex entry;
+	vector<ChainDBIndex> index;
+	boost::uint64_t offset;
+	string code;
+	size_t i, j, k;
+	FILE *fp;
+
+	if ((fp = fopen(filename.c_str(), "wb")) == NULL) {
+		Logger::error("Can not open the file: %s\n", filename.c_str());
+		exit(1);
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, chain_db_magic, sizeof(chain_db_magic));
+	fwrite(&header, sizeof(header), 1, fp);
+	offset = sizeof(header);
+
+	for (i=0; i<chains.size(); i++) {
+		code = chains[i].id_code();
+		if (code.empty()) {
+			// no identifier in the file, so the chain is named by the file
+			code = chains[i].raw_name();
+			code = code.substr(0, code.find(':'));
+			if ((k = code.find_last_of("/\\")) != string::npos) code = code.substr(k + 1);
+			code = code.substr(0, code.find('.'));
+		}
+		memset(&entry, 0, sizeof(entry));
+		code = getName(code, chains[i].chain_id());
+		memcpy(entry.name, code.data(), code.size());
+		entry.chain_index = chains[i].getChainIndex();
+		entry.offset = offset;
+		index.push_back(entry);
+		offset += chains[i].writeRecord(fp);
+	}
+
+	stable_sort(index.begin(), index.end(), _lessName);
+	for (i=0, j=0; i<index.size(); i++) {
+		if (j > 0 && strcmp(index[j-1].name, index[i].name) == 0) {
+			Logger::warning("Duplicate chain %s, only the first one is indexed!", index[i].name);
+			continue;
+		}
+		index[j++] = index[i];
+	}
+	index.resize(j);
+	if (!index.empty()) fwrite(&index[0], sizeof(ChainDBIndex), index.size(), fp);
+
+	header.num_chains = index.size();
+	header.index_offset = offset;
+	fseek(fp, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, fp);
+
+	if (ferror(fp)) {
+		Logger::error("Can not write the file: %s\n", filename.c_str());
+		exit(1);
+	}
+	fclose(fp);
+}
+
+// name of a chain in the index, the code in upper case followed by the chain
+// identifier as given to ProteinChain::setChainID, or the code alone if it is 0
+
+string ChainDB::getName(const string &code, char chain_id)
+{
+	ChainDBIndex entry;
+	string name;
+	size_t i;
+	name = code.substr(0, sizeof(entry.name) - 2);
+	for (i=0; i<name.size(); i++) {
+		name[i] = toupper(name[i]);
+	}
+	if (chain_id == ' ') chain_id = '_';
+	if (chain_id != 0) name += (char) toupper(chain_id);
+	return name;
+}
+
+bool ChainDB::_lessName(const ChainDBIndex &a, const ChainDBIndex &b)
+{
+	return (strncmp(a.name, b.name, sizeof(a.name)) < 0);
+}
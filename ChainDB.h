@@ -0,0 +1,74 @@
+#ifndef __CHAINDB_H
+#define __CHAINDB_H
+
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Binary database of protein chains, written by --extract.
+// The file is a header, one record per chain and an index of the chain names
+// sorted for binary search, with the order of chains in their PDB files. A
+// record is the chain metadata followed by, residue by residue, the CA
+// coordinates in milli-Angstrom axis by axis, the atom serial and residue
+// sequence numbers as 32-bit integers, and the 3-letter residue names.
+// Records are 8-byte aligned and kept in native byte order, so the file is used in
+// place through MappedFile and a chain is loaded by copying its arrays.
+/////////////////////////////////////////////////////////////////////////////////////
+
+
+#include <vector>
+#include <string>
+#include <boost/cstdint.hpp>
+
+#include "Utils.h"
+#include "ProteinChain.h"
+
+
+struct ChainDBHeader {
+	char magic[8];									// "SAMOCDB" and the format version
+	boost::int32_t num_chains;						// Number of chains
+	boost::int32_t reserved;
+	boost::uint64_t index_offset;					// Offset of the index from the start of file
+};
+
+struct ChainDBIndex {
+	char name[20];									// Code in upper case and chain identifier, zero padded
+	boost::int32_t chain_index;						// Index of the chain in its PDB file counted from 1
+	boost::uint64_t offset;							// Offset of the record from the start of file
+};
+
+struct ChainDBRecord {
+	boost::int32_t length;							// Number of residues
+	char id_code[5];								// This identifier is unique within PDB
+	char chain_id;									// Chain identifier
+	char dep_date[10];								// Deposition date
+	char classification[44];						// Classifies the molecule(s)
+};
+
+
+class ChainDB {
+	string m_filename;
+	MappedFile m_file;
+	const ChainDBHeader *m_header;
+	const ChainDBIndex *m_index;					// Index sorted by name
+
+public:
+	ChainDB() { m_header = NULL; m_index = NULL; }
+
+	const char *filename() const { return m_filename.c_str(); }
+	int size() const { return (m_header != NULL) ? m_header->num_chains : 0; }
+	const char *name(int i) const { return m_index[i].name; }
+
+	bool open(const string &filename);
+	void close();
+
+	int find(const string &code, char chain_id = 0, int chain_index = 1) const;
+	void getChain(int i, ProteinChain &chain) const;
+
+	static void writeFile(const string &filename, const vector<ProteinChain> &chains);
+	static string getName(const string &code, char chain_id);
+
+private:
+	static bool _lessName(const ChainDBIndex &a, const ChainDBIndex &b);
+};
+
+
+#endif // __CHAINDB_H
@@ -0,0 +1,130 @@
+#ifndef __DARYHEAP_H
+#define __DARYHEAP_H
+
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Indexed d-ary min-heap of the items 0..n-1 keyed by double values.
+// The heap, the keys and the positions of items are kept in flat arrays, so no
+// node objects are allocated and every operation works on contiguous memory.
+// Items are inserted lazily by update(), and reset() empties the heap without
+// extracting the remaining items.
+/////////////////////////////////////////////////////////////////////////////////////
+
+
+class DaryHeap {
+	enum { D = 4 };
+
+	vector<double> m_keys;							// Key of each item
+	vector<int> m_heap;								// Items in heap order
+	vector<int> m_pos;								// Position of each item in heap, -1 if absent
+	int m_size;
+
+public:
+	DaryHeap() { m_size = 0; }
+
+	int size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	double key(int i) const { return m_keys[i]; }
+
+	inline void reset(int n);
+	inline void update(int i, double key);
+	inline int extractMin();
+
+private:
+	inline void _siftUp(int p);
+	inline void _siftDown(int p);
+};
+
+
+////////////////////////////////
+//
+// implementations of DaryHeap
+
+
+// set all keys to HUGE_VAL and empty the heap
+
+inline void DaryHeap::reset(int n)
+{
+	m_keys.assign(n, HUGE_VAL);
+	m_pos.assign(n, -1);
+	m_heap.resize(n);
+	m_size = 0;
+}
+
+// insert an item or decrease its key
+
+inline void DaryHeap::update(int i, double key)
+{
+	m_keys[i] = key;
+	if (m_pos[i] < 0) {
+		m_pos[i] = m_size;
+		m_heap[m_size++] = i;
+	}
+	_siftUp(m_pos[i]);
+}
+
+// remove the item with minimal key, -1 if the heap is empty
+
+inline int DaryHeap::extractMin()
+{
+	int i;
+	if (m_size == 0) return -1;
+	i = m_heap[0];
+	m_pos[i] = -1;
+	if (--m_size > 0) {
+		m_heap[0] = m_heap[m_size];
+		m_pos[m_heap[0]] = 0;
+		_siftDown(0);
+	}
+	return i;
+}
+
+inline void DaryHeap::_siftUp(int p)
+{
+	int i, q;
+	double key;
+	i = m_heap[p];
+	key = m_keys[i];
+	while (p > 0) {
+		q = (p - 1) / D;
+		if (!(key < m_keys[m_heap[q]])) break;
+		m_heap[p] = m_heap[q];
+		m_pos[m_heap[p]] = p;
+		p = q;
+	}
+	m_heap[p] = i;
+	m_pos[i] = p;
+}
+
+inline void DaryHeap::_siftDown(int p)
+{
+	int i, q, c, c_end;
+	double key, min_key;
+	i = m_heap[p];
+	key = m_keys[i];
+	while ((c = p * D + 1) < m_size) {
+		c_end = min(c + D, m_size);
+		q = c;
+		min_key = m_keys[m_heap[c]];
+		for (c++; c<c_end; c++) {
+			if (m_keys[m_heap[c]] < min_key) {
+				min_key = m_keys[m_heap[c]];
+				q = c;
+			}
+		}
+		if (!(min_key < key)) break;
+		m_heap[p] = m_heap[q];
+		m_pos[m_heap[p]] = p;
+		p = q;
+	}
+	m_heap[p] = i;
+	m_pos[i] = p;
+}
+
+
+#endif // __DARYHEAP_H
@@ -1,51 +1,195 @@
-
-#ifndef __MATRIX_H
-#define __MATRIX_H
-
-
-template <class T>
-class Matrix {
-public:
-	static T **alloc(int row, int col);
-	static T **alloc(int row_l, int row_h, int col_l, int col_h);
-	static void free(T **m, int row_l = 0, int col_l = 0);
-};
-
-
-////////////////////////////////
-//
-// implementations of Matrix
-
-
-template <class T>
-inline T **Matrix<T>::alloc(int row, int col)
-{
-	T **m =	alloc(0, row-1, 0, col-1);
-	return m;
-}
-
-template <class T>
-inline T **Matrix<T>::alloc(int row_l, int row_h, int col_l, int col_h)
-{
-	T **m;
-	long i, nrow=row_h-row_l+1, ncol=col_h-col_l+1;
-	m = new T * [nrow];
-	m -= row_l;
-	m[row_l] = new T [nrow*ncol];
-	m[row_l] -= col_l;
-	for(i=row_l+1; i<=row_h; i++) m[i] = m[i-1] + ncol;
-	return m;
-}
-
-template <class T>
-inline void Matrix<T>::free(T **m, int row_l, int col_l)
-{
-	if (m != NULL) {
-		delete[] (m[row_l]+col_l);
-		delete[] (m+row_l);
-	}
-	m = NULL;
-}
-
-
-#endif // __MATRIX_H
+
+#ifndef __MATRIX_H
+#define __MATRIX_H
+
+
+template <class T>
+class Matrix {
+public:
+	static T **alloc(int row, int col);
+	static T **alloc(int row_l, int row_h, int col_l, int col_h);
+	static void free(T **m, int row_l = 0, int col_l = 0);
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Array of plain values starting at an ALIGNMENT byte boundary, so that loops
+// over it can be vectorized with aligned loads. The values are not initialized,
+// and resize() does not keep them. The block only grows, so an array resized
+// for every call of a solver is allocated once.
+/////////////////////////////////////////////////////////////////////////////////////
+
+template <class T>
+class Vector {
+	char *m_block;
+	T *m_data;
+	int m_size, m_capacity;
+
+public:
+	enum { ALIGNMENT = 32 };
+
+	Vector(int size = 0);
+	Vector(const Vector &v);
+	~Vector() { delete[] m_block; }
+
+	Vector &operator =(const Vector &v);
+
+	T &operator [](int i) { return m_data[i]; }
+	const T &operator [](int i) const { return m_data[i]; }
+
+	int size() const { return m_size; }
+	T *data() { return m_data; }
+	const T *data() const { return m_data; }
+
+	void resize(int size);
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Row-major matrix in one aligned block, with every row padded to start at an
+// ALIGNMENT byte boundary as well. m[i] gives the row pointer, so it is indexed
+// as m[i][j] like the arrays of Matrix<T>, but the block is released with the
+// object. The values are not initialized, and resize() does not keep them.
+/////////////////////////////////////////////////////////////////////////////////////
+
+template <class T>
+class DenseMatrix {
+	Vector<T> m_data;
+	int m_row, m_col, m_stride;
+
+public:
+	DenseMatrix(int row = 0, int col = 0);
+
+	T *operator [](int i) { return m_data.data() + i * m_stride; }
+	const T *operator [](int i) const { return m_data.data() + i * m_stride; }
+
+	int row() const { return m_row; }
+	int col() const { return m_col; }
+	int stride() const { return m_stride; }
+
+	void resize(int row, int col);
+	void fill(const T &value);
+};
+
+
+////////////////////////////////
+//
+// implementations of Matrix
+
+
+template <class T>
+inline T **Matrix<T>::alloc(int row, int col)
+{
+	T **m =	alloc(0, row-1, 0, col-1);
+	return m;
+}
+
+template <class T>
+inline T **Matrix<T>::alloc(int row_l, int row_h, int col_l, int col_h)
+{
+	T **m;
+	long i, nrow=row_h-row_l+1, ncol=col_h-col_l+1;
+	m = new T * [nrow];
+	m -= row_l;
+	m[row_l] = new T [nrow*ncol];
+	m[row_l] -= col_l;
+	for(i=row_l+1; i<=row_h; i++) m[i] = m[i-1] + ncol;
+	return m;
+}
+
+template <class T>
+inline void Matrix<T>::free(T **m, int row_l, int col_l)
+{
+	if (m != NULL) {
+		delete[] (m[row_l]+col_l);
+		delete[] (m+row_l);
+	}
+	m = NULL;
+}
+
+
+
+////////////////////////////////
+//
+// implementations of Vector
+
+
+template <class T>
+inline Vector<T>::Vector(int size)
+{
+	m_block = NULL;
+	m_data = NULL;
+	m_size = 0;
+	m_capacity = 0;
+	resize(size);
+}
+
+template <class T>
+inline Vector<T>::Vector(const Vector &v)
+{
+	m_block = NULL;
+	m_data = NULL;
+	m_size = 0;
+	m_capacity = 0;
+	*this = v;
+}
+
+template <class T>
+inline Vector<T> &Vector<T>::operator =(const Vector &v)
+{
+	int i;
+	if (this != &v) {
+		resize(v.m_size);
+		for (i=0; i<m_size; i++) m_data[i] = v.m_data[i];
+	}
+	return *this;
+}
+
+template <class T>
+inline void Vector<T>::resize(int size)
+{
+	m_size = size;
+	if (size <= m_capacity) return;
+	delete[] m_block;
+	m_capacity = size;
+	m_block = new char [size * sizeof(T) + ALIGNMENT];
+	m_data = (T *) (m_block + ALIGNMENT - ((size_t) m_block) % ALIGNMENT);
+}
+
+
+
+////////////////////////////////
+//
+// implementations of DenseMatrix
+
+
+template <class T>
+inline DenseMatrix<T>::DenseMatrix(int row, int col)
+{
+	m_row = 0;
+	m_col = 0;
+	m_stride = 0;
+	resize(row, col);
+}
+
+template <class T>
+inline void DenseMatrix<T>::resize(int row, int col)
+{
+	int n;
+	n = Vector<T>::ALIGNMENT / sizeof(T);
+	m_row = row;
+	m_col = col;
+	m_stride = (n > 1) ? (col + n - 1) / n * n : col;
+	m_data.resize(m_row * m_stride);
+}
+
+template <class T>
+inline void DenseMatrix<T>::fill(const T &value)
+{
+	int i, n;
+	n = m_data.size();
+	for (i=0; i<n; i++) m_data[i] = value;
+}
+
+
+#endif // __MATRIX_H
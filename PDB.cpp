@@ -1,390 +1,821 @@
-
-#include <set>
-#include <string>
-#include <cstdio>
-
-#include "Utils.h"
-#include "PDB.h"
-
-#include "MemLeak.h"
-
-
-////////////////////////////////
-//
-// class PDBAtom
-
-PDBAtom::PDBAtom()
-{
-	int i;
-
-	m_serial = 0;
-	for (i=0; i<5; i++) m_name[i] = 0;
-	for (i=0; i<4; i++) m_res_name[i] = 0;
-	m_chain_id = ' ';
-	m_pocket_id = 0;
-	m_res_seq = 0;
-	m_coord[0] = 0;
-	m_coord[1] = 0;
-	m_coord[2] = 0;
-}
-
-bool PDBAtom::isCa() const
-{
-	return (strcmp(m_name, " CA ") == 0);
-}
-
-bool PDBAtom::isIdenticalAtom(const PDBAtom &atom) const
-{
-	return (strcmp(m_name, atom.m_name) == 0);
-}
-
-bool PDBAtom::isIdenticalResidue(const PDBAtom &atom) const
-{
-	return (strcmp(m_res_name, atom.m_res_name) == 0);
-}
-
-const char PDBAtom::_getResidueCode(const char *name)
-{
-	char code;
-	if (strncmp(name, "ALA", 3) == 0) code = 'A';
-	else if (strncmp(name, "ASX", 3) == 0) code = 'B';
-	else if (strncmp(name, "CYS", 3) == 0) code = 'C';
-	else if (strncmp(name, "ASP", 3) == 0) code = 'D';
-	else if (strncmp(name, "GLU", 3) == 0) code = 'E';
-	else if (strncmp(name, "PHE", 3) == 0) code = 'F';
-	else if (strncmp(name, "GLY", 3) == 0) code = 'G';
-	else if (strncmp(name, "HIS", 3) == 0) code = 'H';
-	else if (strncmp(name, "ILE", 3) == 0) code = 'I';
-	else if (strncmp(name, "LYS", 3) == 0) code = 'K';
-	else if (strncmp(name, "LEU", 3) == 0) code = 'L';
-	else if (strncmp(name, "MET", 3) == 0) code = 'M';
-	else if (strncmp(name, "ASN", 3) == 0) code = 'N';
-	else if (strncmp(name, "PRO", 3) == 0) code = 'P';
-	else if (strncmp(name, "GLN", 3) == 0) code = 'Q';
-	else if (strncmp(name, "ARG", 3) == 0) code = 'R';
-	else if (strncmp(name, "SER", 3) == 0) code = 'S';
-	else if (strncmp(name, "THR", 3) == 0) code = 'T';
-	else if (strncmp(name, "VAL", 3) == 0) code = 'V';
-	else if (strncmp(name, "TRP", 3) == 0) code = 'W';
-	else if (strncmp(name, "TYR", 3) == 0) code = 'Y';
-	else if (strncmp(name, "GLZ", 3) == 0) code = 'Z';
-	else code = '-';
-	return code;
-}
-
-
-////////////////////////////////
-//
-// class PDB
-
-PDB::PDB(const char *filename)
-{
-	if (filename != NULL) setFilename(filename);
-	else setFilename("unkown");
-	clearData();
-}
-
-int PDB::getPocketID(int index)
-{
-	set<int> pockets;
-	int i, j, pid;
-
-	pid = -2;
-	for (i=0; i<m_atoms.size(); ++i) {
-		j = m_atoms[i].pocket_id();
-		if (!pockets.count(j)) {
-			pockets.insert(j);
-			if (pockets.size() >= index) {
-				pid = j;
-				break;
-			}
-		}
-	}
-	return pid;
-}
-
-char PDB::getChainID(int index)
-{
-	set<char> chains;
-	int i, j;
-	char cid;
-
-	cid = -2;
-	for (i=0; i<m_atoms.size(); ++i) {
-		j = m_atoms[i].chain_id();
-		if (!chains.count(j)) {
-			chains.insert(j);
-			if (chains.size() >= index) {
-				cid = j;
-				break;
-			}
-		}
-	}
-	return cid;
-}
-
-void PDB::readFile(const string &fn)
-{	
-	FILE *fp;
-	char buffer[100];
-	int i;
-
-	if (!fn.empty()) setFilename(fn);
-
-	if ((fp = fopen(filename(), "r")) == NULL) {
-		Logger::error("Can not open the file: %s\n", filename());
-		exit(1);
-	}
-
-	clearData();
-	Logger::debug("Read PDB file: %s", filename());
-
-	i = 0;
-	while (!feof(fp)) {
-		fgets(buffer, 100, fp);
-
-/////////////////////////////////////////////////////////////////////////////////////
-// The HEADER record uniquely identifies a PDB entry through the idCode field. This
-// record also provides a classification for the entry. Finally, it contains the
-// date the coordinates were deposited at the PDB. 
-//
-// COLUMNS        DATA TYPE       FIELD           DEFINITION
-// ----------------------------------------------------------------------------------
-//  1 -  6        Record name     "HEADER"
-// 11 - 50        String(40)      classification  Classifies the molecule(s)
-// 51 - 59        Date            depDate         Deposition date.  This is the date
-//                                                the coordinates were received by
-//                                                the PDB
-// 63 - 66        IDcode          idCode          This identifier is unique within PDB
-/////////////////////////////////////////////////////////////////////////////////////
-
-		if (strncmp(buffer, "HEADER", 6) == 0) {
-			sscanf(buffer, "%*10c%40c%9c%*3c%4c\n", m_classification, m_dep_date, m_id_code);
-		}
-
-/////////////////////////////////////////////////////////////////////////////////////
-// The COMPND record describes the macromolecular contents of an entry. Each
-// macromolecule found in the entry is described by a set of token: value pairs,
-// and is referred to as a COMPND record component. Since the concept of a molecule
-// is difficult to specify exactly, PDB staff may exercise editorial judgment in
-// consultation with depositors in assigning these names.
-// For each macromolecular component, the molecule name, synonyms, number assigned
-// by the Enzyme Commission (EC), and other relevant details are specified. 
-//
-// COLUMNS        DATA TYPE         FIELD          DEFINITION
-// ----------------------------------------------------------------------------------
-//  1 -  6        Record name       "COMPND"
-//  9 - 10        Continuation      continuation   Allows concatenation of multiple records.
-// 11 - 70        Specification     compound       Description of the molecular
-//                list                             components.
-/////////////////////////////////////////////////////////////////////////////////////
-
-		else if (strncmp(buffer, "COMPND", 6) == 0) {
-			char buf[61];
-			buf[60] = 0;
-			sscanf(buffer, "%*10c%60c\n", buf);
-			m_components.push_back(buf);
-		}
-
-/////////////////////////////////////////////////////////////////////////////////////
-// The MASTER record is a control record for bookkeeping. It lists the number of
-// lines in the coordinate entry or file for selected record types. 
-//
-// COLUMNS       DATA TYPE      FIELD         DEFINITION
-// ----------------------------------------------------------------------------------
-//  1 -  6       Record name    "MASTER"
-// 11 - 15       Integer        numRemark     Number of REMARK records
-// 16 - 20       Integer        "0"
-// 21 - 25       Integer        numHet        Number of HET records
-// 26 - 30       Integer        numHelix      Number of HELIX records
-// 31 - 35       Integer        numSheet      Number of SHEET records
-// 36 - 40       Integer        numTurn       Number of TURN records
-// 41 - 45       Integer        numSite       Number of SITE records
-// 46 - 50       Integer        numXform      Number of coordinate transformation
-//                                            records (ORIGX+SCALE+MTRIX)
-// 51 - 55       Integer        numCoord      Number of atomic coordinate records
-//                                            (ATOM+HETATM)
-// 56 - 60       Integer        numTer        Number of TER records
-// 61 - 65       Integer        numConect     Number of CONECT records
-// 66 - 70       Integer        numSeq        Number of SEQRES records
-/////////////////////////////////////////////////////////////////////////////////////
-
-		else if (strncmp(buffer, "MASTER", 6) == 0)	{
-			sscanf(buffer, "%*50c%5d\n", &m_num_coord);
-		}
-
-/////////////////////////////////////////////////////////////////////////////////////
-// The ATOM records present the atomic coordinates for standard residues. They also
-// present the occupancy and temperature factor for each atom. Heterogen coordinates
-// use the HETATM record type. The element symbol is always present on each ATOM
-// record; segment identifier and charge are optional. 
-//
-// COLUMNS        DATA TYPE       FIELD         DEFINITION
-// ---------------------------------------------------------------------------------
-//  1 -  6        Record name     "ATOM  "
-//  7 - 11        Integer         serial        Atom serial number.
-// 13 - 16        Atom            name          Atom name.
-// 17             Character       altLoc        Alternate location indicator.
-// 18 - 20        Residue name    resName       Residue name.
-// 22             Character       chainID       Chain identifier.
-// 23 - 26        Integer         resSeq        Residue sequence number.
-// 27             AChar           iCode         Code for insertion of residues.
-// 31 - 38        Real(8.3)       x             Orthogonal coordinates for X in
-//                                              Angstroms.
-// 39 - 46        Real(8.3)       y             Orthogonal coordinates for Y in
-//                                              Angstroms.
-// 47 - 54        Real(8.3)       z             Orthogonal coordinates for Z in
-//                                              Angstroms.
-// 55 - 60        Real(6.2)       occupancy     Occupancy.
-// 61 - 66        Real(6.2)       tempFactor    Temperature factor.
-// 73 - 76        LString(4)      segID         Segment identifier, left-justified.
-// 77 - 78        LString(2)      element       Element symbol, right-justified.
-// 79 - 80        LString(2)      charge        Charge on the atom.
-/////////////////////////////////////////////////////////////////////////////////////
-
-		else if (strncmp(buffer, "ATOM  ", 6) == 0) {
-			PDBAtom atom;
-			sscanf(buffer, "%*6c%5d%*c%4c%*c%3c%*c%c%4d%*c%*3c%8lf%8lf%8lf\n",
-				&atom.m_serial,
-				atom.m_name,
-				atom.m_res_name,
-				&atom.m_chain_id,
-				&atom.m_res_seq,
-				&atom.m_coord[0],
-				&atom.m_coord[1],
-				&atom.m_coord[2]);
-//			Logger::debug("%5d, %4s, %3s, %c, %4d, %8.3f, %8.3f, %8.3f\n",
-//				atom->m_serial,
-//				atom->m_name,
-//				atom->m_res_name,
-//				atom->m_chain_id,
-//				atom->m_res_seq,
-//				atom->m_coord[0],
-//				atom->m_coord[1],
-//				atom->m_coord[2]);
-			m_atoms.push_back(atom);
-		}	
-
-/////////////////////////////////////////////////////////////////////////////////////
-// The ENDMDL records are paired with MODEL records to group individual structures
-// found in a coordinate entry. 
-
-// COLUMNS         DATA TYPE        FIELD           DEFINITION
-// ------------------------------------------------------------------
-//  1 -  6         Record name      "ENDMDL"
-/////////////////////////////////////////////////////////////////////////////////////
-
-		else if (strncmp(buffer, "ENDMDL", 6) == 0) {
-			break;
-		}
-
-/////////////////////////////////////////////////////////////////////////////////////
-// The END record marks the end of the PDB file. 
-//
-// COLUMNS       DATA TYPE      FIELD     DEFINITION
-// -------------------------------------------------------
-//  1 -  6       Record name    "END   "
-/////////////////////////////////////////////////////////////////////////////////////
-
-		else if (strncmp(buffer, "END   ", 6) == 0) {
-			break;
-		}
-	}
-	fclose(fp);
-
-	Logger::debug("\tDatabase Code: %s", m_id_code);
-	Logger::debug("\tClassification: %s", m_classification);
-	Logger::debug("\tNumber of Coordinate Records: %d", m_num_coord);
-}
-
-void PDB::readPocket(const string &fn)
-{	
-	FILE *fp;
-	char buffer[100];
-	int i;
-
-	if (!fn.empty()) setFilename(fn);
-
-	if ((fp = fopen(filename(), "r")) == NULL) {
-		Logger::error("Can not open the file: %s\n", filename());
-		exit(1);
-	}
-
-	clearData();
-	Logger::debug("Read Pocket file: %s", filename());
-
-	i = 0;
-	while (!feof(fp)) {
-		fgets(buffer, 100, fp);
-
-/////////////////////////////////////////////////////////////////////////////////////
-// The ATOM records present the atomic coordinates for standard residues. They also
-// present the occupancy and temperature factor for each atom. Heterogen coordinates
-// use the HETATM record type. The element symbol is always present on each ATOM
-// record; segment identifier and charge are optional. 
-//
-// COLUMNS        DATA TYPE       FIELD         DEFINITION
-// ---------------------------------------------------------------------------------
-//  1 -  6        Record name     "ATOM  "
-//  7 - 11        Integer         serial        Atom serial number.
-// 13 - 16        Atom            name          Atom name.
-// 17             Character       altLoc        Alternate location indicator.
-// 18 - 20        Residue name    resName       Residue name.
-// 22             Character       chainID       Chain identifier.
-// 23 - 26        Integer         resSeq        Residue sequence number.
-// 27             AChar           iCode         Code for insertion of residues.
-// 31 - 38        Real(8.3)       x             Orthogonal coordinates for X in
-//                                              Angstroms.
-// 39 - 46        Real(8.3)       y             Orthogonal coordinates for Y in
-//                                              Angstroms.
-// 47 - 54        Real(8.3)       z             Orthogonal coordinates for Z in
-//                                              Angstroms.
-// 55 - 60        Real(6.2)       occupancy     Occupancy.
-// 61 - 66        Real(6.2)       tempFactor    Temperature factor.
-//
-// 67 - 70        Integer         pocketID      Pocket identifier.
-//
-// 73 - 76        LString(4)      segID         Segment identifier, left-justified.
-// 77 - 78        LString(2)      element       Element symbol, right-justified.
-// 79 - 80        LString(2)      charge        Charge on the atom.
-/////////////////////////////////////////////////////////////////////////////////////
-
-		if (strncmp(buffer, "ATOM  ", 6) == 0) {
-			PDBAtom atom;
-			sscanf(buffer, "%*6c%5d%*c%4c%*c%3c%*c%c%4d%*c%*3c%8lf%8lf%8lf%*6lf%*6lf%4d\n",
-				&atom.m_serial,
-				atom.m_name,
-				atom.m_res_name,
-				&atom.m_chain_id,
-				&atom.m_res_seq,
-				&atom.m_coord[0],
-				&atom.m_coord[1],
-				&atom.m_coord[2],
-				&atom.m_pocket_id);
-// 			Logger::debug("%5d, %4s, %3s, %c, %4d, %8.3f, %8.3f, %8.3f, %4d\n",
-// 				atom.m_serial,
-// 				atom.m_name,
-// 				atom.m_res_name,
-// 				atom.m_chain_id,
-// 				atom.m_res_seq,
-// 				atom.m_coord[0],
-// 				atom.m_coord[1],
-// 				atom.m_coord[2],
-// 				atom.m_pocket_id);
-			m_atoms.push_back(atom);
-		}
-	}
-	fclose(fp);
-}
-
-void PDB::clearData()
-{
-	int i;
-
-	for (i=0; i<5; i++) m_id_code[i] = 0;
-	for (i=0; i<10; i++) m_dep_date[i] = 0;
-	for (i=0; i<41; i++) m_classification[i] = 0;
-	m_components.clear();
-	m_num_coord = 0;
-	m_atoms.clear();
-}
+
+#include <set>
+#include <map>
+#include <string>
+#include <cstdio>
+
+#include "Utils.h"
+#include "PDB.h"
+
+#include "MemLeak.h"
+
+
+////////////////////////////////
+//
+// class PDBAtom
+
+PDBAtom::PDBAtom()
+{
+	int i;
+
+	m_serial = 0;
+	for (i=0; i<5; i++) m_name[i] = 0;
+	for (i=0; i<4; i++) m_res_name[i] = 0;
+	m_chain_id = ' ';
+	m_pocket_id = 0;
+	m_res_seq = 0;
+	m_coord[0] = 0;
+	m_coord[1] = 0;
+	m_coord[2] = 0;
+}
+
+bool PDBAtom::isCa() const
+{
+	return (strcmp(m_name, " CA ") == 0);
+}
+
+bool PDBAtom::isIdenticalAtom(const PDBAtom &atom) const
+{
+	return (strcmp(m_name, atom.m_name) == 0);
+}
+
+bool PDBAtom::isIdenticalResidue(const PDBAtom &atom) const
+{
+	return (strcmp(m_res_name, atom.m_res_name) == 0);
+}
+
+const char PDBAtom::_getResidueCode(const char *name)
+{
+	char code;
+	if (strncmp(name, "ALA", 3) == 0) code = 'A';
+	else if (strncmp(name, "ASX", 3) == 0) code = 'B';
+	else if (strncmp(name, "CYS", 3) == 0) code = 'C';
+	else if (strncmp(name, "ASP", 3) == 0) code = 'D';
+	else if (strncmp(name, "GLU", 3) == 0) code = 'E';
+	else if (strncmp(name, "PHE", 3) == 0) code = 'F';
+	else if (strncmp(name, "GLY", 3) == 0) code = 'G';
+	else if (strncmp(name, "HIS", 3) == 0) code = 'H';
+	else if (strncmp(name, "ILE", 3) == 0) code = 'I';
+	else if (strncmp(name, "LYS", 3) == 0) code = 'K';
+	else if (strncmp(name, "LEU", 3) == 0) code = 'L';
+	else if (strncmp(name, "MET", 3) == 0) code = 'M';
+	else if (strncmp(name, "ASN", 3) == 0) code = 'N';
+	else if (strncmp(name, "PRO", 3) == 0) code = 'P';
+	else if (strncmp(name, "GLN", 3) == 0) code = 'Q';
+	else if (strncmp(name, "ARG", 3) == 0) code = 'R';
+	else if (strncmp(name, "SER", 3) == 0) code = 'S';
+	else if (strncmp(name, "THR", 3) == 0) code = 'T';
+	else if (strncmp(name, "VAL", 3) == 0) code = 'V';
+	else if (strncmp(name, "TRP", 3) == 0) code = 'W';
+	else if (strncmp(name, "TYR", 3) == 0) code = 'Y';
+	else if (strncmp(name, "GLZ", 3) == 0) code = 'Z';
+	else code = '-';
+	return code;
+}
+
+
+// window of inflated data for gzip files, which grows for longer lines
+
+static const size_t read_window = 1 << 20;
+
+
+////////////////////////////////
+//
+// readers of fixed columns, counted from 1 as in the format description, the
+// columns beyond the end of a line are blank
+
+
+// at most 9 digits are read, so the value can not overflow
+
+static int read_int(const char *line, int length, int column, int width)
+{
+	const char *p = line + column - 1, *end = line + min(column - 1 + width, length);
+	int value, digits;
+	bool negative;
+	while (p < end && *p == ' ') p++;
+	negative = (p < end && *p == '-');
+	if (p < end && (*p == '-' || *p == '+')) p++;
+	value = 0;
+	for (digits=0; p < end && *p >= '0' && *p <= '9' && digits < 9; digits++) {
+		value = value * 10 + (*p++ - '0');
+	}
+	return negative ? -value : value;
+}
+
+// the digits are gathered into an integer, which is exact, and divided once by
+// a power of ten, so the value is rounded as by strtod
+
+static double read_real(const char *line, int length, int column, int width)
+{
+	static const double scale[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+	const char *p = line + column - 1, *end = line + min(column - 1 + width, length);
+	char buffer[32];
+	double mantissa;
+	int digits;
+	bool negative;
+	if (p >= end) return 0;
+	while (p < end && *p == ' ') p++;
+	negative = (p < end && *p == '-');
+	if (p < end && (*p == '-' || *p == '+')) p++;
+	mantissa = 0;
+	while (p < end && *p >= '0' && *p <= '9') {
+		mantissa = mantissa * 10 + (*p++ - '0');
+	}
+	digits = 0;
+	if (p < end && *p == '.') {
+		for (p++; p < end && *p >= '0' && *p <= '9' && digits < 9; digits++) {
+			mantissa = mantissa * 10 + (*p++ - '0');
+		}
+	}
+	if (p < end && *p != ' ') {
+		// exponents and long fractions are left to the library
+		p = line + column - 1;
+		digits = min((int) (end - p), (int) sizeof(buffer) - 1);
+		memcpy(buffer, p, digits);
+		buffer[digits] = 0;
+		return atof(buffer);
+	}
+	mantissa /= scale[digits];
+	return negative ? -mantissa : mantissa;
+}
+
+static void read_chars(const char *line, int length, int column, int width, char *s)
+{
+	if (column - 1 + width > length) width = length - column + 1;
+	if (width > 0) memcpy(s, line + column - 1, width);
+}
+
+static bool is_record(const char *line, int length, const char *name)
+{
+	return (length >= 6 && memcmp(line, name, 6) == 0);
+}
+
+// the next line of the buffer without its line break, returns false at the end
+
+static bool next_line(const char *&p, const char *end, const char *&line, int &length)
+{
+	const char *eol;
+	if (p >= end) return false;
+	eol = (const char *) memchr(p, '\n', end - p);
+	if (eol == NULL) eol = end;
+	line = p;
+	length = eol - p;
+	if (length > 0 && line[length-1] == '\r') length--;
+	p = (eol < end) ? eol + 1 : end;
+	return true;
+}
+
+// the next line of a file read window by window, the window is moved on while
+// the line runs to its end
+
+static bool next_line(MappedFile &file, const char *&p, const char *&line, int &length)
+{
+	while (memchr(p, '\n', file.data() + file.size() - p) == NULL && file.more(p));
+	return next_line(p, file.data() + file.size(), line, length);
+}
+
+
+static bool in_range(const PDBFilter &filter, int res_seq)
+{
+	return ((res_seq >= filter.range[0] || filter.range[0] <= 0)
+			&& (res_seq <= filter.range[1] || filter.range[1] <= 0));
+}
+
+
+////////////////////////////////
+//
+// tokens of mmCIF (PDBx) data, http://mmcif.wwpdb.org/
+
+
+static bool is_space(char c)
+{
+	return (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+}
+
+// the next token without its quotes, text fields between semicolons at the
+// start of lines are single tokens, returns false at the end
+
+static bool next_token(const char *&p, const char *begin, const char *end, const char *&token, int &length, bool &quoted)
+{
+	char quote;
+	while (p < end) {
+		if (*p == '#') {
+			while (p < end && *p != '\n') p++;
+		}
+		else if (is_space(*p)) {
+			p++;
+		}
+		else {
+			break;
+		}
+	}
+	if (p >= end) return false;
+	quoted = true;
+	if (*p == ';' && (p == begin || p[-1] == '\n')) {
+		token = ++p;
+		while (p < end && !(*p == ';' && p[-1] == '\n')) p++;
+		length = p - token;
+		while (length > 0 && is_space(token[length-1])) length--;
+		if (p < end) p++;
+	}
+	else if (*p == '\'' || *p == '"') {
+		quote = *p;
+		token = ++p;
+		while (p < end && !(*p == quote && (p + 1 == end || is_space(p[1])))) p++;
+		length = p - token;
+		if (p < end) p++;
+	}
+	else {
+		quoted = false;
+		token = p;
+		while (p < end && !is_space(*p)) p++;
+		length = p - token;
+	}
+	return true;
+}
+
+// data names and reserved words end the values of a loop
+
+static bool is_keyword(const char *token, int length, bool quoted)
+{
+	if (quoted) return false;
+	return (token[0] == '_'
+			|| (length >= 5 && (strncmp(token, "loop_", 5) == 0 || strncmp(token, "data_", 5) == 0
+				|| strncmp(token, "save_", 5) == 0 || strncmp(token, "stop_", 5) == 0))
+			|| (length >= 7 && strncmp(token, "global_", 7) == 0));
+}
+
+static bool is_token(const char *token, int length, const char *word)
+{
+	return (length == (int) strlen(word) && memcmp(token, word, length) == 0);
+}
+
+// move the window of a file on from mark if a scan ran to its end, the tokens
+// from mark on are then scanned again as one of them may be cut
+
+static bool next_window(MappedFile &file, const char *&mark, const char *p, const char *&begin, const char *&end)
+{
+	if (p < end || !file.more(mark)) return false;
+	begin = file.data();
+	end = begin + file.size();
+	return true;
+}
+
+static bool is_cif(const char *data, size_t size)
+{
+	const char *p = data, *token;
+	int length;
+	bool quoted;
+	return (next_token(p, data, data + size, token, length, quoted) && !quoted && length >= 5 && strncmp(token, "data_", 5) == 0);
+}
+
+
+////////////////////////////////
+//
+// class PDB
+
+PDB::PDB(const char *filename)
+{
+	if (filename != NULL) setFilename(filename);
+	else setFilename("unkown");
+	clearData();
+}
+
+int PDB::getPocketID(int index)
+{
+	set<int> pockets;
+	int i, j, pid;
+
+	pid = -2;
+	for (i=0; i<m_atoms.size(); ++i) {
+		j = m_atoms[i].pocket_id();
+		if (!pockets.count(j)) {
+			pockets.insert(j);
+			if (pockets.size() >= index) {
+				pid = j;
+				break;
+			}
+		}
+	}
+	return pid;
+}
+
+// chains are recorded while reading, so filtered atoms are counted as well
+
+char PDB::getChainID(int index)
+{
+	if (m_chain_ids.empty()) return -2;
+	if (index > (int) m_chain_ids.size()) return -2;
+	return m_chain_ids[max(index, 1) - 1];
+}
+
+// index counted from 1 of a chain in order of appearance, 0 if it is absent
+
+int PDB::getChainIndex(char chain_id)
+{
+	string::size_type n;
+	n = m_chain_ids.find(chain_id);
+	return (n == string::npos) ? 0 : (int) n + 1;
+}
+
+void PDB::readFile(const string &fn, const PDBFilter *filter)
+{	
+	PDBFilter all;
+	MappedFile file;
+	const char *p, *end, *line;
+	int length, chain_index, n;
+
+	if (!fn.empty()) setFilename(fn);
+
+	if (!file.open(filename(), read_window)) {
+		Logger::error("Can not open the file: %s\n", filename());
+		exit(1);
+	}
+
+	clearData();
+	if (filter == NULL) {
+		filter = &all;
+	}
+	else {
+		m_filtered = true;
+	}
+	if (is_cif(file.data(), file.size())) {
+		Logger::debug("Read mmCIF file: %s", filename());
+		_readCIF(file, *filter);
+		Logger::debug("\tDatabase Code: %s", m_id_code);
+		Logger::debug("\tNumber of Coordinate Records: %d", m_num_coord);
+		return;
+	}
+	Logger::debug("Read PDB file: %s", filename());
+
+	// the MASTER record is one of the last lines, so the atoms can be reserved
+	// before the coordinate section is read unless the file is read in windows
+	end = file.data() + file.size();
+	p = file.eof() ? end : file.data();
+	for (n=0; n<4 && p>file.data(); n++) {
+		line = p - 1;
+		if (line > file.data() && *line == '\n') line--;
+		while (line > file.data() && line[-1] != '\n') line--;
+		if (is_record(line, p - line, "MASTER")) {
+			m_num_coord = read_int(line, p - line, 51, 5);
+			break;
+		}
+		p = line;
+	}
+	if (!filter->backbone && filter->chain_id == -1) {
+		m_atoms.reserve(min(m_num_coord, (int) (file.size() / 54)));
+	}
+
+	chain_index = 0;
+	p = file.data();
+	while (next_line(file, p, line, length)) {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// The HEADER record uniquely identifies a PDB entry through the idCode field. This
+// record also provides a classification for the entry. Finally, it contains the
+// date the coordinates were deposited at the PDB. 
+//
+// COLUMNS        DATA TYPE       FIELD           DEFINITION
+// ----------------------------------------------------------------------------------
+//  1 -  6        Record name     "HEADER"
+// 11 - 50        String(40)      classification  Classifies the molecule(s)
+// 51 - 59        Date            depDate         Deposition date.  This is the date
+//                                                the coordinates were received by
+//                                                the PDB
+// 63 - 66        IDcode          idCode          This identifier is unique within PDB
+/////////////////////////////////////////////////////////////////////////////////////
+
+		if (is_record(line, length, "HEADER")) {
+			read_chars(line, length, 11, 40, m_classification);
+			read_chars(line, length, 51, 9, m_dep_date);
+			read_chars(line, length, 63, 4, m_id_code);
+		}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// The COMPND record describes the macromolecular contents of an entry. Each
+// macromolecule found in the entry is described by a set of token: value pairs,
+// and is referred to as a COMPND record component. Since the concept of a molecule
+// is difficult to specify exactly, PDB staff may exercise editorial judgment in
+// consultation with depositors in assigning these names.
+// For each macromolecular component, the molecule name, synonyms, number assigned
+// by the Enzyme Commission (EC), and other relevant details are specified. 
+//
+// COLUMNS        DATA TYPE         FIELD          DEFINITION
+// ----------------------------------------------------------------------------------
+//  1 -  6        Record name       "COMPND"
+//  9 - 10        Continuation      continuation   Allows concatenation of multiple records.
+// 11 - 70        Specification     compound       Description of the molecular
+//                list                             components.
+/////////////////////////////////////////////////////////////////////////////////////
+
+		else if (is_record(line, length, "COMPND")) {
+			char buf[61];
+			memset(buf, 0, sizeof(buf));
+			read_chars(line, length, 11, 60, buf);
+			m_components.push_back(buf);
+		}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// The MASTER record is a control record for bookkeeping. It lists the number of
+// lines in the coordinate entry or file for selected record types. 
+//
+// COLUMNS       DATA TYPE      FIELD         DEFINITION
+// ----------------------------------------------------------------------------------
+//  1 -  6       Record name    "MASTER"
+// 11 - 15       Integer        numRemark     Number of REMARK records
+// 16 - 20       Integer        "0"
+// 21 - 25       Integer        numHet        Number of HET records
+// 26 - 30       Integer        numHelix      Number of HELIX records
+// 31 - 35       Integer        numSheet      Number of SHEET records
+// 36 - 40       Integer        numTurn       Number of TURN records
+// 41 - 45       Integer        numSite       Number of SITE records
+// 46 - 50       Integer        numXform      Number of coordinate transformation
+//                                            records (ORIGX+SCALE+MTRIX)
+// 51 - 55       Integer        numCoord      Number of atomic coordinate records
+//                                            (ATOM+HETATM)
+// 56 - 60       Integer        numTer        Number of TER records
+// 61 - 65       Integer        numConect     Number of CONECT records
+// 66 - 70       Integer        numSeq        Number of SEQRES records
+/////////////////////////////////////////////////////////////////////////////////////
+
+		else if (is_record(line, length, "MASTER"))	{
+			m_num_coord = read_int(line, length, 51, 5);
+		}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// The ATOM records present the atomic coordinates for standard residues. They also
+// present the occupancy and temperature factor for each atom. Heterogen coordinates
+// use the HETATM record type. The element symbol is always present on each ATOM
+// record; segment identifier and charge are optional. 
+//
+// COLUMNS        DATA TYPE       FIELD         DEFINITION
+// ---------------------------------------------------------------------------------
+//  1 -  6        Record name     "ATOM  "
+//  7 - 11        Integer         serial        Atom serial number.
+// 13 - 16        Atom            name          Atom name.
+// 17             Character       altLoc        Alternate location indicator.
+// 18 - 20        Residue name    resName       Residue name.
+// 22             Character       chainID       Chain identifier.
+// 23 - 26        Integer         resSeq        Residue sequence number.
+// 27             AChar           iCode         Code for insertion of residues.
+// 31 - 38        Real(8.3)       x             Orthogonal coordinates for X in
+//                                              Angstroms.
+// 39 - 46        Real(8.3)       y             Orthogonal coordinates for Y in
+//                                              Angstroms.
+// 47 - 54        Real(8.3)       z             Orthogonal coordinates for Z in
+//                                              Angstroms.
+// 55 - 60        Real(6.2)       occupancy     Occupancy.
+// 61 - 66        Real(6.2)       tempFactor    Temperature factor.
+// 73 - 76        LString(4)      segID         Segment identifier, left-justified.
+// 77 - 78        LString(2)      element       Element symbol, right-justified.
+// 79 - 80        LString(2)      charge        Charge on the atom.
+/////////////////////////////////////////////////////////////////////////////////////
+
+		else if (is_record(line, length, "ATOM  ")) {
+			if (_selectAtom(line, length, *filter, chain_index)) {
+				m_atoms.push_back(PDBAtom());
+				_readAtom(line, length, m_atoms.back());
+			}
+		}	
+
+/////////////////////////////////////////////////////////////////////////////////////
+// The ENDMDL records are paired with MODEL records to group individual structures
+// found in a coordinate entry. 
+
+// COLUMNS         DATA TYPE        FIELD           DEFINITION
+// ------------------------------------------------------------------
+//  1 -  6         Record name      "ENDMDL"
+/////////////////////////////////////////////////////////////////////////////////////
+
+		else if (is_record(line, length, "ENDMDL")) {
+			break;
+		}
+
+/////////////////////////////////////////////////////////////////////////////////////
+// The END record marks the end of the PDB file. 
+//
+// COLUMNS       DATA TYPE      FIELD     DEFINITION
+// -------------------------------------------------------
+//  1 -  6       Record name    "END   "
+/////////////////////////////////////////////////////////////////////////////////////
+
+		else if (is_record(line, length, "END   ")) {
+			break;
+		}
+	}
+
+	Logger::debug("\tDatabase Code: %s", m_id_code);
+	Logger::debug("\tClassification: %s", m_classification);
+	Logger::debug("\tNumber of Coordinate Records: %d", m_num_coord);
+}
+
+// Read the first model of the _atom_site loop of mmCIF data in one pass. The
+// columns are located by their names once, and then the tokens of each row are
+// kept as pointers into the window of the file, so only the atoms passing the
+// filter are decoded. A loop header, row or data item cut at the end of the
+// window is scanned again once the window has moved on. Author chain identifiers, residue numbers and names are preferred as
+// in PDB files. Multi-letter chain identifiers are cut to their first letter,
+// and it is an error if that merges chains that are read or counted. Atom names
+// are aligned as in PDB files, so " CA " is a C-alpha.
+
+void PDB::_readCIF(MappedFile &file, const PDBFilter &filter)
+{
+	enum { GROUP, SERIAL, TYPE, LABEL_ATOM, AUTH_ATOM, LABEL_COMP, AUTH_COMP, LABEL_ASYM, AUTH_ASYM,
+		   LABEL_SEQ, AUTH_SEQ, X, Y, Z, MODEL, FIELD_NUM };
+	static const char *names[FIELD_NUM] = {
+		"group_PDB", "id", "type_symbol", "label_atom_id", "auth_atom_id", "label_comp_id", "auth_comp_id",
+		"label_asym_id", "auth_asym_id", "label_seq_id", "auth_seq_id", "Cartn_x", "Cartn_y", "Cartn_z",
+		"pdbx_PDB_model_num" };
+	static const char *months[12] = {
+		"JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC" };
+	const char *p, *q, *mark, *begin, *end, *token, *name, *asym;
+	string last_asym;
+	vector<const char *> values;
+	vector<int> lengths;
+	map<char, string> chain_names;
+	map<char, string>::iterator ni;
+	int field[FIELD_NUM], column[FIELD_NUM];
+	int length, column_num, chain_index, model, name_length, asym_length, month, i, k;
+	bool found, quoted, atom_site;
+	char chain_id, atom_name[5];
+
+	begin = file.data();
+	end = begin + file.size();
+	p = begin;
+	chain_index = 0;
+	model = 0;
+	while (true) {
+		mark = p;
+		found = next_token(p, begin, end, token, length, quoted);
+		if (next_window(file, mark, p, begin, end)) {
+			p = mark;
+			continue;
+		}
+		if (!found) break;
+		if (quoted) continue;
+		if (length > 5 && strncmp(token, "data_", 5) == 0) {
+			if (m_id_code[0] == 0) read_chars(token + 5, length - 5, 1, 4, m_id_code);
+		}
+		else if (is_token(token, length, "loop_")) {
+			// names of the columns
+			column_num = 0;
+			atom_site = false;
+			for (k=0; k<FIELD_NUM; k++) field[k] = -1;
+			q = p;
+			while (next_token(q, begin, end, token, length, quoted) && !quoted && token[0] == '_') {
+				p = q;
+				if (length > 11 && strncmp(token, "_atom_site.", 11) == 0) {
+					atom_site = true;
+					for (k=0; k<FIELD_NUM; k++) {
+						if (is_token(token + 11, length - 11, names[k])) field[k] = column_num;
+					}
+				}
+				column_num++;
+			}
+			if (next_window(file, mark, q, begin, end)) {
+				p = mark;
+				continue;
+			}
+			if (!atom_site || column_num == 0) continue;
+
+			// rows of atoms
+			values.resize(column_num);
+			lengths.resize(column_num);
+			while (true) {
+				mark = p;
+				for (i=0; i<column_num; i++) {
+					q = p;
+					if (!next_token(q, begin, end, token, length, quoted) || is_keyword(token, length, quoted)) break;
+					p = q;
+					values[i] = token;
+					lengths[i] = length;
+				}
+				if (next_window(file, mark, q, begin, end)) {
+					p = mark;
+					continue;
+				}
+				if (i < column_num) break;
+				m_num_coord++;
+				for (k=0; k<FIELD_NUM; k++) {
+					column[k] = field[k];
+				}
+				// author fields are optional, and unknown values are '.' or '?'
+				for (k=AUTH_ATOM; k<=AUTH_SEQ; k+=2) {
+					if (column[k] < 0 || (lengths[column[k]] == 1 && (values[column[k]][0] == '.' || values[column[k]][0] == '?'))) {
+						column[k] = column[k-1];
+					}
+				}
+				if (column[MODEL] >= 0) {
+					k = read_int(values[column[MODEL]], lengths[column[MODEL]], 1, lengths[column[MODEL]]);
+					if (model == 0) model = k;
+					if (k != model) return;
+				}
+				if (column[GROUP] >= 0 && !is_token(values[column[GROUP]], lengths[column[GROUP]], "ATOM")) continue;
+				if (column[AUTH_ATOM] < 0 || column[X] < 0 || column[Y] < 0 || column[Z] < 0) continue;
+
+				// numbers longer than the readers take are rejected
+				for (i=0; i<3 && lengths[column[X+i]] < 32; i++);
+				if (i < 3 || (column[SERIAL] >= 0 && lengths[column[SERIAL]] > 10)
+					|| (column[AUTH_SEQ] >= 0 && lengths[column[AUTH_SEQ]] > 10)) {
+					Logger::warning("Invalid atom record %d in mmCIF file %s!", m_num_coord, filename());
+					continue;
+				}
+
+				asym = (column[AUTH_ASYM] >= 0) ? values[column[AUTH_ASYM]] : "";
+				asym_length = (column[AUTH_ASYM] >= 0) ? lengths[column[AUTH_ASYM]] : 0;
+				chain_id = (asym_length > 0) ? asym[0] : ' ';
+				if (chain_names.empty() || last_asym.compare(0, string::npos, asym, asym_length) != 0) {
+					// a chain is kept by the first letter of its identifier, which must
+					// not be shared with another chain where it is read or counted
+					ni = chain_names.find(chain_id);
+					if (ni == chain_names.end()) {
+						chain_names[chain_id] = string(asym, asym_length);
+					}
+					else if (ni->second.compare(0, string::npos, asym, asym_length) != 0
+							 && (filter.chain_id == -1 || filter.chain_id == 0 || filter.chain_id == chain_id)) {
+						Logger::error("Chains %s and %.*s of mmCIF file %s can not be told apart by the chain identifier %c!",
+							ni->second.c_str(), asym_length, asym, filename(), chain_id);
+						exit(1);
+					}
+					last_asym.assign(asym, asym_length);
+				}
+				if (!_selectChain(chain_id, filter, chain_index)) continue;
+
+				// names of one-letter elements start at the second column
+				memcpy(atom_name, "    ", 5);
+				name = values[column[AUTH_ATOM]];
+				name_length = min(lengths[column[AUTH_ATOM]], 4);
+				k = (name_length < 4 && (column[TYPE] < 0 || lengths[column[TYPE]] < 2)) ? 1 : 0;
+				memcpy(atom_name + k, name, min(name_length, 4 - k));
+				if (filter.backbone && strcmp(atom_name, " CA ") != 0) continue;
+
+				k = (column[AUTH_SEQ] >= 0) ? read_int(values[column[AUTH_SEQ]], lengths[column[AUTH_SEQ]], 1, lengths[column[AUTH_SEQ]]) : 0;
+				if (!in_range(filter, k)) continue;
+
+				m_atoms.push_back(PDBAtom());
+				PDBAtom &atom = m_atoms.back();
+				if (column[SERIAL] >= 0) {
+					atom.m_serial = read_int(values[column[SERIAL]], lengths[column[SERIAL]], 1, lengths[column[SERIAL]]);
+				}
+				memcpy(atom.m_name, atom_name, 4);
+				if (column[AUTH_COMP] >= 0) {
+					read_chars(values[column[AUTH_COMP]], min(lengths[column[AUTH_COMP]], 3), 1, 3, atom.m_res_name);
+				}
+				atom.m_chain_id = chain_id;
+				atom.m_res_seq = k;
+				for (i=0; i<3; i++) {
+					atom.m_coord[i] = read_real(values[column[X+i]], lengths[column[X+i]], 1, lengths[column[X+i]]);
+				}
+			}
+		}
+		else if (token[0] == '_') {
+			name = token;
+			name_length = length;
+			q = p;
+			found = next_token(q, begin, end, token, length, quoted);
+			if (next_window(file, mark, q, begin, end)) {
+				p = mark;
+				continue;
+			}
+			if (!found || is_keyword(token, length, quoted)) continue;
+			p = q;
+			if (is_token(name, name_length, "_entry.id")) {
+				memset(m_id_code, 0, sizeof(m_id_code));
+				read_chars(token, length, 1, 4, m_id_code);
+			}
+			else if (is_token(name, name_length, "_struct_keywords.pdbx_keywords")) {
+				read_chars(token, length, 1, 40, m_classification);
+			}
+			else if (is_token(name, name_length, "_pdbx_database_status.recvd_initial_deposition_date") && length == 10) {
+				// YYYY-MM-DD as DD-MON-YY of PDB files
+				month = read_int(token, length, 6, 2);
+				if (month >= 1 && month <= 12) {
+					sprintf(m_dep_date, "%.2s-%s-%.2s", token + 8, months[month-1], token + 2);
+				}
+			}
+		}
+	}
+}
+
+void PDB::readPocket(const string &fn)
+{	
+	PDBFilter all;
+	MappedFile file;
+	const char *p, *line;
+	int length, chain_index;
+
+	if (!fn.empty()) setFilename(fn);
+
+	if (!file.open(filename(), read_window)) {
+		Logger::error("Can not open the file: %s\n", filename());
+		exit(1);
+	}
+
+	clearData();
+	Logger::debug("Read Pocket file: %s", filename());
+
+	chain_index = 0;
+	p = file.data();
+	while (next_line(file, p, line, length)) {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// The ATOM records present the atomic coordinates for standard residues. They also
+// present the occupancy and temperature factor for each atom. Heterogen coordinates
+// use the HETATM record type. The element symbol is always present on each ATOM
+// record; segment identifier and charge are optional. 
+//
+// COLUMNS        DATA TYPE       FIELD         DEFINITION
+// ---------------------------------------------------------------------------------
+//  1 -  6        Record name     "ATOM  "
+//  7 - 11        Integer         serial        Atom serial number.
+// 13 - 16        Atom            name          Atom name.
+// 17             Character       altLoc        Alternate location indicator.
+// 18 - 20        Residue name    resName       Residue name.
+// 22             Character       chainID       Chain identifier.
+// 23 - 26        Integer         resSeq        Residue sequence number.
+// 27             AChar           iCode         Code for insertion of residues.
+// 31 - 38        Real(8.3)       x             Orthogonal coordinates for X in
+//                                              Angstroms.
+// 39 - 46        Real(8.3)       y             Orthogonal coordinates for Y in
+//                                              Angstroms.
+// 47 - 54        Real(8.3)       z             Orthogonal coordinates for Z in
+//                                              Angstroms.
+// 55 - 60        Real(6.2)       occupancy     Occupancy.
+// 61 - 66        Real(6.2)       tempFactor    Temperature factor.
+//
+// 67 - 70        Integer         pocketID      Pocket identifier.
+//
+// 73 - 76        LString(4)      segID         Segment identifier, left-justified.
+// 77 - 78        LString(2)      element       Element symbol, right-justified.
+// 79 - 80        LString(2)      charge        Charge on the atom.
+/////////////////////////////////////////////////////////////////////////////////////
+
+		if (is_record(line, length, "ATOM  ")) {
+			_selectAtom(line, length, all, chain_index);
+			m_atoms.push_back(PDBAtom());
+			_readAtom(line, length, m_atoms.back());
+			m_atoms.back().m_pocket_id = read_int(line, length, 67, 4);
+		}
+	}
+}
+
+// record the chain of an ATOM record and test it against the filter, only the
+// columns of the predicates are read; chain_index is the index of the chain of
+// the previous record, which is looked up again only when the chain changes
+
+bool PDB::_selectAtom(const char *line, int length, const PDBFilter &filter, int &chain_index)
+{
+	char chain_id = ' ';
+
+	read_chars(line, length, 22, 1, &chain_id);
+	if (!_selectChain(chain_id, filter, chain_index)) return false;
+	if (filter.backbone && (length < 16 || memcmp(line + 12, " CA ", 4) != 0)) return false;
+	if (filter.range[0] > 0 || filter.range[1] > 0) {
+		return in_range(filter, read_int(line, length, 23, 4));
+	}
+	return true;
+}
+
+bool PDB::_selectChain(char chain_id, const PDBFilter &filter, int &chain_index)
+{
+	string::size_type n;
+
+	if (chain_index == 0 || m_chain_ids[chain_index-1] != chain_id) {
+		n = m_chain_ids.find(chain_id);
+		if (n == string::npos) {
+			n = m_chain_ids.size();
+			m_chain_ids += chain_id;
+		}
+		chain_index = n + 1;
+	}
+	if (filter.chain_id == 0) return (chain_index == max(filter.chain_index, 1));
+	return (filter.chain_id == -1 || chain_id == filter.chain_id);
+}
+
+// the fields of an ATOM record up to the coordinates
+
+void PDB::_readAtom(const char *line, int length, PDBAtom &atom)
+{
+	atom.m_serial = read_int(line, length, 7, 5);
+	read_chars(line, length, 13, 4, atom.m_name);
+	read_chars(line, length, 18, 3, atom.m_res_name);
+	read_chars(line, length, 22, 1, &atom.m_chain_id);
+	atom.m_res_seq = read_int(line, length, 23, 4);
+	atom.m_coord[0] = read_real(line, length, 31, 8);
+	atom.m_coord[1] = read_real(line, length, 39, 8);
+	atom.m_coord[2] = read_real(line, length, 47, 8);
+}
+
+void PDB::clearData()
+{
+	int i;
+
+	for (i=0; i<5; i++) m_id_code[i] = 0;
+	for (i=0; i<10; i++) m_dep_date[i] = 0;
+	for (i=0; i<41; i++) m_classification[i] = 0;
+	m_components.clear();
+	m_num_coord = 0;
+	m_atoms.clear();
+	m_chain_ids.clear();
+	m_filtered = false;
+}
@@ -1,1094 +1,2312 @@
-
-#include <map>
-#include <numeric>
-
-#include "Utils.h"
-#include "Matrix.h"
-#include "PairAlign.h"
-#include "SVD.h"
-#include "FibHeap.h"
-
-#include "MemLeak.h"
-
-
-#define square(d) ((d)*(d))
-#define get_square_distance(x, y) (square((x)[0]-(y)[0])+square((x)[1]-(y)[1])+square((x)[2]-(y)[2]))
-#define get_distance(x, y) sqrt(get_square_distance(x, y))
-#define get_outer_distance(x, y, i, j) get_distance((x)[i], (y)[j])
-#define get_inner_distance(x, i, j) get_distance((x)[i], (x)[j])
-
-
-////////////////////////////////
-//
-// class PairAlign
-
-PairAlign::PairAlign(ProteinChain *chain_a, ProteinChain *chain_b)
-{
-	int i, j;
-	m_chain_a = chain_a;
-	m_chain_b = chain_b;
-	for (i=0; i<3; i++) {
-		m_translation[i] = 0;
-		for (j=0; j<3; j++) {
-			m_rotation[i][j] = 0;
-		}
-		m_rotation[i][i] = 1.0;
-	}
-	if (m_chain_a != NULL) {
-		m_length_a = m_chain_a->length();
-		m_alignment.resize(m_length_a, -1);
-	}
-	if (m_chain_b != NULL) {
-		m_length_b = m_chain_b->length();
-	}
-}
-
-void PairAlign::setChain(int i, ProteinChain *chain)
-{
-	if (i == 0) {
-		m_chain_a = chain;
-		if (m_chain_a != NULL && m_length_a != m_chain_a->length()) {
-			m_length_a = m_chain_a->length();
-			m_alignment.resize(m_length_a);
-		}
-	}
-	else {
-		m_chain_b = chain;
-		if (m_chain_b != NULL && m_length_b != m_chain_b->length()) {
-			m_length_b = m_chain_b->length();
-		}
-	}
-}
-
-double PairAlign::align()
-{
-	m_align_num = 0;
-	m_break_num = 0;
-	m_permu_num = 0;
-	m_sequence_identity = 0;
-	m_rmsd = 0;
-	if (m_length_a == 0 || m_length_b == 0)
-	{
-		Logger::warning("Attmpt to align empty chain!");
-		return m_rmsd;
-	}
-	initWeights();
-	if (m_params.branch_and_bound) {
-		alignBNB();
-	}
-	else {
-		alignITER();
-	}
-
-// 	m_chain_a->writeChainCode(stderr);
-// 	Logger::info("");
-// 
-// 	for (int i=0; i<m_length_a; i++) {
-// 		if (m_alignment[i] >= 0) fprintf(stderr, "%c", (*m_chain_b)[m_alignment[i]].resCode());
-// 		else fprintf(stderr, "%c", '.');
-// 	}
-// 	Logger::info("");
-// 
-// 	m_chain_b->writeChainCode(stderr);
-// 	Logger::info("");
-
-	return m_rmsd;
-}
-
-double PairAlign::alignBNB()
-{
-	double translation[3], rotation[3][3], lambda2, rmsd, score;
-	int align_num;
-	vector<int> alignment(m_length_a);
-	vector<int> occupied(m_length_b);
-
-	int index, i;
-
-	lambda2 = m_params.lambda * m_params.lambda;
-
-	alignITER();
-	
-	for (i=0; i<m_length_a; i++) {
-		alignment[i] = -1;
-	}
-	for (i=0; i<m_length_b; i++) {
-		occupied[i] = false;
-	}
-
-	index = 0;
-	while (index >= 0) {
-		i = alignment[index];
-		if (i < -1) {
-			// backtracking
-			alignment[index] = -1;
-			index--;
-			continue;
-		}
-		else if (i >=0 && i < m_length_b) {
-			occupied[i] = false;
-		}
-		do {
-			i++;
-		} while(i >= 0 && i < m_length_b && occupied[i]);
-		if (i >= m_length_b) {
-			i = -2;
-		}
-		alignment[index] = i;
-		if (i >= 0 && i < m_length_b) {
-			occupied[i] = true;
-			// test branch
-			align_num = _getAlignNum(alignment);
-			if (align_num >= 1 && solveLeastSquare(translation, rotation, alignment)) {
-				rmsd = m_chain_a->getRMSD(*m_chain_b, translation, rotation, alignment);
-				score = (rmsd * rmsd - lambda2) * align_num;
-//				Logger::debug("\tAligned: %d, RMSD: %f, Score: %f, Best: %f", align_num, rmsd, score, best_score);
-				if (score < m_score) {
-					// incumbent, candidate of best solution
-					m_score = score;
-					m_align_num = align_num;
-					m_rmsd = rmsd;
-					setSolution(translation, rotation, alignment);
-					Logger::debug("\tScore: %f, Aligned: %d, RMSD: %f", score, align_num, rmsd);
-				}
-				else if (score-lambda2*(m_length_a-index-1) >= m_score) {
-					// bad branch, pruning
-					continue;
-				}
-			}
-		}
-		if (index < m_length_a-1) {
-			// go on, next position
-			index++;
-			continue;
-		}
-		else {
-			// last position, next value
-			continue;
-		}
-	}
-
-	return m_rmsd;
-}
-
-double PairAlign::alignITER()
-{
-	double translation[3], rotation[3][3], lambda, rmsd;
-	int align_num;
-	double score_old, score_new;
-	int start_index;
-	vector<int> alignment(m_length_a);
-	m_score = HUGE_VAL;
-	start_index = 0;
-	while (getStart(start_index++, alignment)) {
-		solveLeastSquare(translation, rotation, alignment);
-		Logger::info("\tInitial solution: %f", m_chain_a->getRMSD(*m_chain_b, translation, rotation, alignment));
-		if (m_params.annealing) {
-			lambda = m_params.annealing_initial;
-			do {
-				score_new = HUGE_VAL;
-				do {
-					score_old = score_new;
-					solveLeastSquare(translation, rotation, alignment);
-					score_new = solveMaxMatch(translation, rotation, alignment, m_params.lambda+lambda);
-					Logger::debug("\t%f, %f", m_params.lambda+lambda, score_new);
-					if (score_new > score_old) {
-						Logger::warning("Not convergent!");
-						break;
-					}
-				} while (fabs(score_new - score_old) > 0.01);
-				lambda *= m_params.annealing_rate;
-			} while(lambda > 0.01);
-		}
-		else {
-			score_new = HUGE_VAL;
-			do {
-				score_old = score_new;
-				solveLeastSquare(translation, rotation, alignment);
-				score_new = solveMaxMatch(translation, rotation, alignment, m_params.lambda);
-				Logger::debug("\t%f", score_new);
-				if (score_new > score_old) {
-					Logger::warning("Not convergent!");
-					break;
-				}
-			} while (fabs(score_new - score_old) > 0.01);
-		}
-		score_new = solveMaxMatch(translation, rotation, alignment, m_params.lambda);
-		align_num = _getAlignNum(alignment);
-		rmsd = m_chain_a->getRMSD(*m_chain_b, translation, rotation, alignment);
-		Logger::info("\tScore: %f, Aligned: %d, RMSD: %f", score_new, align_num, rmsd);
-		Logger::info("===============================================================================");
-		if (score_new < m_score) {
-			m_score = score_new;
-			m_align_num = align_num;
-			m_rmsd = rmsd;
-			setSolution(translation, rotation, alignment);
-		}
-	}
-
-	return m_rmsd;
-}
-
-double PairAlign::continueAlign()
-{
-	double score_old, score_new;
-	score_new = HUGE_VAL;
-	do {
-		score_old = score_new;
-		solveLeastSquare(m_translation, m_rotation, m_alignment);
-		score_new = solveMaxMatch(m_translation, m_rotation, m_alignment, m_params.lambda);
-	} while (fabs(score_new - score_old) > 0.01);
-	m_align_num = _getAlignNum(m_alignment);
-	m_rmsd = m_chain_a->getRMSD(*m_chain_b, m_translation, m_rotation, m_alignment);
-	return m_rmsd;
-}
-
-void PairAlign::postProcess()
-{
-	postAlign();
-	m_break_num = _getBreakNum(m_alignment);
-	m_permu_num = _getPermuNum(m_alignment);
-	Logger::info("PairAlign: %s (size=%d) vs %s (size=%d)\n\tAligned = %d, RMSD = %f\n\tBreak/Permutation = %d/%d, SeqId = %5.3f",
-		m_chain_a->raw_name(), m_length_a, m_chain_b->raw_name(), m_length_b,
-		m_align_num, m_rmsd, m_break_num, m_permu_num, _getSequenceIdentity(m_alignment));
-
-	if (m_params.sequential_order) {
-		postAlign(true);
-		Logger::info("PostAlign: %s (size=%d) vs %s (size=%d)\n\tAligned = %d, RMSD = %f\n\tBreak/Permutation = %d/%d, SeqId = %5.3f",
-			m_chain_a->raw_name(), m_length_a, m_chain_b->raw_name(), m_length_b,
-			m_align_num, m_rmsd, m_break_num, m_permu_num, _getSequenceIdentity(m_alignment));
-	}
-}
-
-double PairAlign::postAlign(bool seq_order)
-{
-	int i, j;
-	for (i=0; i<m_length_a; ++i) {
-		for (j=0; j<m_length_b; ++j) {
-			m_weights[i][j] = 1.0;
-		}
-	}
-	if (seq_order) {
-		solveMaxAlign(m_translation, m_rotation, m_alignment, m_params.lambda);
-	}
-	else {
-		solveMaxMatch(m_translation, m_rotation, m_alignment, m_params.lambda);
-	}
-	m_align_num = _getAlignNum(m_alignment);
-	m_rmsd = m_chain_a->getRMSD(*m_chain_b, m_translation, m_rotation, m_alignment);
-	m_break_num = _getBreakNum(m_alignment);
-	m_permu_num = _getPermuNum(m_alignment);
-	return m_rmsd;
-}
-
-bool PairAlign::getStart(int index, vector<int> &alignment)
-{
-	int i, j, k;
-	int block_length, block_number_a, block_number_b;
-	int block_a, block_b;
-
-	for (k=0; k<m_length_a; k++) {
-		alignment[k] = -1;
-	}
-	if (m_params.heuristic_start > 0) {
-		block_length = (max(m_length_a, m_length_b) + m_params.heuristic_start - 1) / m_params.heuristic_start;
-		block_number_a = (m_length_a + block_length - 1) / block_length;
-		block_number_b = (m_length_b + block_length - 1) / block_length;
-
-		block_a = index / block_number_b;
-		block_b = index % block_number_b;
-
-		if (block_a < block_number_a) {
-			for (k=0; k<block_length; k++) {
-				i = block_a * block_length + k;
-				j = block_b * block_length + k;
-				if (i < m_length_a && j < m_length_b) {
-					alignment[i] = j;
-				}
-			}
-			return true;
-		}
-	}
-	else {
-		if (index == 0) {
-			for (k=0; k<m_length_a; k++) {
-				alignment[k] = k;
-			}
-			return true;
-		}
-	}
-	return false;
-}
-
-void PairAlign::initWeights()
-{
-	int i, j, k, l;
-	int num_a, num_b;
-	double s, max_s;
-	vector<vector<double> > inner_distance_a, inner_distance_b, similarity;
-
-	m_weights.resize(m_length_a);
-	for (i=0; i<m_length_a; ++i) {
-		m_weights[i].resize(m_length_b);
-	}
-
-	for (i=0; i<m_length_a; ++i) {
-		for (j=0; j<m_length_b; ++j) {
-			m_weights[i][j] = 0.0;
-		}
-	}
-
-	// init weights by local structure
-
-	// using distance matrix to setup initial solutions
-
-	if (m_params.weight_method == "LS") {
-		num_a = m_length_a - m_params.fragment_length + 1;
-		num_b = m_length_b - m_params.fragment_length + 1;
-		inner_distance_a.resize(m_length_a);
-		for (i=0; i<m_length_a; ++i) {
-			inner_distance_a[i].resize(m_length_a);
-		}
-		inner_distance_b.resize(m_length_b);
-		for (i=0; i<m_length_b; ++i) {
-			inner_distance_b[i].resize(m_length_b);
-		}
-		similarity.resize(num_a);
-		for (i=0; i<num_a; ++i) {
-			similarity[i].resize(num_b);
-		}
-
-		for (i=0; i<m_length_a; ++i) {
-			for (j=0; j<=i; ++j) {
-				inner_distance_a[i][j] = get_inner_distance(*m_chain_a, i, j);
-				inner_distance_a[j][i] = inner_distance_a[i][j];
-			}
-		}
-		for (i=0; i<m_length_b; ++i) {
-			for (j=0; j<=i; ++j) {
-				inner_distance_b[i][j] = get_inner_distance(*m_chain_b, i, j);
-				inner_distance_b[j][i] = inner_distance_b[i][j];
-			}
-		}
-		max_s = 0;
-		for (i=0; i<num_a; ++i) {
-			for (j=0; j<num_b; ++j) {
-				s = 0;
-				for (k=0; k<m_params.fragment_length; k++) {
-					for (l=0; l<m_params.fragment_length; l++) {
-						s += fabs(inner_distance_a[i+k][i+l] - inner_distance_b[j+k][j+l]);
-					}
-				}
-				similarity[i][j] = s / (m_params.fragment_length * m_params.fragment_length);
-				max_s = max(similarity[i][j], max_s);
-			}
-		}
-
-		for (i=0; i<num_a; ++i) {
-			for (j=0; j<num_b; ++j) {
- 				m_weights[i][j] = (max_s - similarity[i][j]) / max_s;
-			}
-		}
-	}
-
-	// init weights by sequence identity
-// 	for (i=0; i<m_length_a; ++i) {
-// 		for (j=0; j<m_length_b; ++j) {
-// 			if ((*m_chain_a)[i].resCode() == (*m_chain_b)[j].resCode()) {
-// 				m_weights[i][j] = 1.0;
-// 			}
-// 			else {
-// 				m_weights[i][j] = 0;
-// 			}
-// 		}
-// 	}
-}
-
-double PairAlign::evaluate(const string &filename)
-{
-	FILE *fp;
-	char buffer[100];
-	int i, j;
-	bool has_alignment, has_tranlation, has_rotation;
-
-	has_alignment = false;
-	has_tranlation = false;
-	has_rotation = false;
-
-	for (i=0; i<m_length_a; i++) {
-		m_alignment[i] = -1;
-	}
-	for (i=0; i<3; i++) {
-		m_translation[i] = 0;
-		for (j=0; j<3; j++) {
-			m_rotation[i][j] = 0;
-		}
-		m_rotation[i][i] = 1.0;
-	}
-
-	if ((fp = fopen(filename.c_str(), "r")) == NULL) {
-		Logger::error("Can not open the file: %s\n", filename.c_str());
-		exit(1);
-	}
-
-	while (!feof(fp)) {
-		fgets(buffer, 100, fp);
-
-		if (strncmp(buffer, "[Alignment]", 11) == 0) {
-			for (i=0; i<m_length_a; i++) {
-				fscanf(fp, "%d", &m_alignment[i]);
-			}
-			has_alignment = true;
-		}
-		else if (strncmp(buffer, "[Translation]", 13) == 0) {
-			for (i=0; i<3; i++) {
-				fscanf(fp, "%lf", &m_translation[i]);
-			}
-			has_tranlation = true;
-		}
-		else if (strncmp(buffer, "[Rotation]", 10) == 0) {
-			for (i=0; i<3; i++) {
-				for (j=0; j<3; j++) {
-					fscanf(fp, "%lf", &m_rotation[i][j]);
-				}
-			}
-			has_rotation = true;
-		}
-	}
-	
-	fclose(fp);
-
-	if (has_alignment) {
-		solveLeastSquare(m_translation, m_rotation, m_alignment);
-	}
-	else if (has_tranlation && has_rotation) {
-		solveMaxMatch(m_translation, m_rotation, m_alignment, m_params.lambda);
-	}
-	else if (has_tranlation) {
-		Logger::error("Rotation matrix is missing!");
-		exit(1);
-	}
-	else {
-		Logger::error("Translation matrix is missing!");
-		exit(1);
-	}
-
-	m_align_num = _getAlignNum(m_alignment);
-	m_rmsd = m_chain_a->getRMSD(*m_chain_b, m_translation, m_rotation, m_alignment);
-	Logger::debug("\tEvaluated: %d, RMSD: %f", m_align_num, m_rmsd);
-
-	return m_rmsd;
-}
-
-double PairAlign::improve(const string &filename)
-{
-	double score_old, score_new;
-
-	evaluate(filename);
-	score_new = HUGE_VAL;
-	do {
-		score_old = score_new;
-		solveLeastSquare(m_translation, m_rotation, m_alignment);
-		score_new = solveMaxMatch(m_translation, m_rotation, m_alignment, m_params.lambda);
-		Logger::debug("\t%f", score_new);
-		if (score_new > score_old) {
-			Logger::warning("Not convergent!");
-			break;
-		}
-	} while (fabs(score_new - score_old) > 0.01);
-	solveMaxMatch(m_translation, m_rotation, m_alignment, m_params.lambda);
-
-	m_align_num = _getAlignNum(m_alignment);
-	m_rmsd = m_chain_a->getRMSD(*m_chain_b, m_translation, m_rotation, m_alignment);
-	Logger::debug("\tImproved: %d, RMSD: %f", m_align_num, m_rmsd);
-
-	return m_rmsd;
-}
-
-void PairAlign::setSolution(const double translation[3], const double rotation[3][3], const vector<int> &alignment)
-{
-	int i, j;
-	for (i=0; i<3; i++) {
-		m_translation[i] = translation[i];
-		for (j=0; j<3; j++) {
-			m_rotation[i][j] = rotation[i][j];
-		}
-	}
-	for (i=0; i<m_length_a; i++) {
-		m_alignment[i] = alignment[i];
-	}
-}
-
-bool PairAlign::solveLeastSquare(double translation[3], double rotation[3][3], vector<int> &alignment)
-{
-	double weight, center_a[3], center_b[3], min_sv_val;
-	double **matrix_u, **matrix_v, vector_d[4], det;
-	bool success;
-	int min_sv_ind, i, j, k, l;
-
-	matrix_u = Matrix<double>::alloc(1, 3, 1, 3);
-	matrix_v = Matrix<double>::alloc(1, 3, 1, 3);
-
-	for (i=0; i<3; i++) {
-		center_a[i] = 0;
-		center_b[i] = 0;
-	}
-	for (i=0; i<3; i++) {
-		for (j=0; j<3; j++) {
-			matrix_u[i+1][j+1] = 0;
-		}
-	}
-
-	weight = 0;
-	for (k=0; k<m_length_a; k++) {
-		l = alignment[k];
-		if (l >= 0) {
-			for (i=0; i<3; i++) {
-				center_a[i] += (*m_chain_a)[k][i] * m_weights[k][l];
-				center_b[i] += (*m_chain_b)[l][i] * m_weights[k][l];
-			}
-			for (i=0; i<3; i++) {
-				for (j=0; j<3; j++) {
-					matrix_u[i+1][j+1] += (*m_chain_a)[k][i] * (*m_chain_b)[l][j] * m_weights[k][l];
-				}
-			}
-		}
-		weight += m_weights[k][l];
-	}
-
-	for (i=0; i<3; i++) {
-		center_a[i] /= weight;
-		center_b[i] /= weight;
-	}
-	for (i=0; i<3; i++) {
-		for (j=0; j<3; j++) {
-			matrix_u[i+1][j+1] -= center_a[i] * center_b[j] * weight;
-		}
-	}
-
-	det = matrix_u[1][1] * matrix_u[2][2] * matrix_u[3][3];
-	det += matrix_u[1][2] * matrix_u[2][3] * matrix_u[3][1];
-	det += matrix_u[1][3] * matrix_u[2][1] * matrix_u[3][2];
-	det -= matrix_u[1][3] * matrix_u[2][2] * matrix_u[3][1];
-	det -= matrix_u[1][2] * matrix_u[2][1] * matrix_u[3][3];
-	det -= matrix_u[1][1] * matrix_u[2][3] * matrix_u[3][2];
-
-	svdcmp(matrix_u, 3, 3, vector_d, matrix_v);
-
-	success = true;
-	if (det < 0) {
-		min_sv_val = HUGE_VAL;
-		for (i=1; i<=3; i++) {
-			if (vector_d[i] < min_sv_val) {
-				min_sv_val = vector_d[i];
-				min_sv_ind = i;
-			}
-		}
-		if (min_sv_val > 1e-6) {
-			Logger::debug("Degenerate case, SVD method fails!");
-			Logger::debug("\t\tD = (%f, %f, %f)", vector_d[1], vector_d[2], vector_d[3]);
-			success = false;
-		}
-		for (i=1; i<=3; i++) {
-			matrix_v[i][min_sv_ind] = - matrix_v[i][min_sv_ind];
-		}
-	}
-
-	for (i=0; i<3; i++) {
-		for (j=0; j<3; j++) {
-			rotation[i][j] = 0;
-			for (k=0; k<3; k++) {
-				rotation[i][j] += matrix_v[i+1][k+1] * matrix_u[j+1][k+1];
-			}
-		}
-	}
-	for (i=0; i<3; i++) {
-		translation[i] = center_b[i];
-		for (j=0; j<3; j++) {
-			translation[i] -= rotation[i][j] * center_a[j];
-		}
-	}
-
-	Matrix<double>::free(matrix_u, 1, 1);
-	Matrix<double>::free(matrix_v, 1, 1);
-	return success;
-}
-
-
-// for using FibHeap
-
-class HeapNode: public FibHeapNode
-{
-	double m_label;
-	int m_index;
-
-public:
-	HeapNode() : FibHeapNode() { m_label = 0; };
-
-	virtual void operator =(FibHeapNode& RHS);
-	virtual int  operator ==(FibHeapNode& RHS);
-	virtual int  operator <(FibHeapNode& RHS);
-
-	virtual void operator =(double key);
-
-	double getKeyValue() { return m_label; }
-	void setKeyValue(double key) { m_label = key; }
-
-	int getIndexValue() { return m_index; }
-	void setIndexValue(int i) { m_index = i; }
-};
-
-void HeapNode::operator =(double label)
-{
-	HeapNode temp;
-	temp.m_label = m_label = label;
-	FHN_assign(temp);
-}
-
-void HeapNode::operator =(FibHeapNode& RHS)
-{
-	FHN_assign(RHS);
-	m_label = ((HeapNode&) RHS).m_label;
-}
-
-int  HeapNode::operator ==(FibHeapNode& RHS)
-{
-	if (FHN_compare(RHS)) return 0;
-	return m_label == ((HeapNode&) RHS).m_label ? 1 : 0;
-}
-
-int  HeapNode::operator <(FibHeapNode& RHS)
-{
-	int X;
-
-	if ((X=FHN_compare(RHS)) != 0) return X < 0 ? 1 : 0;
-	return m_label < ((HeapNode&) RHS).m_label ? 1 : 0;
-}
-
-
-double PairAlign::solveMaxMatch(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda)
-{
-	double score, reduced_cost, **weight, label_t, current_value;
-	bool *match_free, *label_free;
-	int *active_num, **active_index, *backtrack, backtrack_t;
-	HeapNode *label, *min_label, temp_label;
-	FibHeap heap;
-	double d;
-	int i, j, k;
-
-	weight = Matrix<double>::alloc(m_length_b+1, m_length_a);
-	match_free = new bool [m_length_b+m_length_a];
-	label_free = new bool [m_length_b+m_length_a];
-	active_num = new int [m_length_b];
-	active_index = Matrix<int>::alloc(m_length_b, m_length_a);
-	backtrack = new int [m_length_b+m_length_a];
-	label = new HeapNode [m_length_b+m_length_a];
-
-	double **matrix = m_chain_a->getMatrix(translation, rotation);
-	for (i=0; i<m_length_b; i++) {
-		for (j=0; j<m_length_a; j++) {
-			weight[i][j] = 0;
-			for (k=0; k<3; k++) {
-				d = matrix[j][k] - (*m_chain_b)[i][k];
-				weight[i][j] += d * d;
-			}
-		}
-	}
-	Matrix<double>::free(matrix);
-
-	lambda = lambda * lambda;
-	for (i=0; i<m_length_b; i++) {
-		active_num[i] = 0;
-		for (j=0; j<m_length_a; j++) {
-			weight[i][j] -= lambda;
-			if (weight[i][j] <= 0) {
-				active_index[i][active_num[i]] = j;
-				active_num[i]++;
-			}
-			weight[i][j] *= m_weights[j][i];
-		}
-	}
-	
-	for (i=0; i<m_length_b+m_length_a; i++) {
-		label[i].setIndexValue(i);
-		match_free[i] = true;
-	}
-	for (j=0; j<m_length_a; j++) {
-		alignment[j] = -1;
-		weight[m_length_b][j] = 0;
-	}
-
-	reduced_cost = 0;
-	for (i=0; i<m_length_b; i++) {
-		for (j=0; j<active_num[i]; j++) {
-			k = active_index[i][j];
-			if (weight[i][k] < reduced_cost) {
-				reduced_cost = weight[i][k];
-			}
-		}
-	}
-	for (i=0; i<m_length_b; i++) {
-		for (j=0; j<active_num[i]; j++) {
-			k = active_index[i][j];
-			weight[i][k] -= reduced_cost;
-		}
-	}
-	score = 0;
-
-	while (true) {
-		// Dijkstra's algorithm
-		for (i=0; i<m_length_b+m_length_a; i++) {
-			if (i < m_length_b && match_free[i]) {
-				label[i].setKeyValue(0);
-			}
-			else {
-				label[i].setKeyValue(HUGE_VAL);
-			}
-			heap.insert(&label[i]);
-			label_free[i] = true;
-			backtrack[i] = -1;
-		}
-		label_t = HUGE_VAL;
-		backtrack_t = -1;
-		while (true) {
-			min_label = (HeapNode *)heap.extractMin();
-			if (min_label == NULL || min_label->getKeyValue() >= HUGE_VAL) break;
-			i = min_label->getIndexValue();
-			current_value = min_label->getKeyValue();
-			label_free[i] = false;
-			if (i < m_length_b) {
-				for (j=0; j<active_num[i]; j++) {
-					k = active_index[i][j];
-					if (label_free[m_length_b+k] && alignment[k] != i) {
-						d = current_value + weight[i][k];
-						if (d < label[m_length_b+k].getKeyValue()) {
-							temp_label = label[m_length_b+k];
-							temp_label.setKeyValue(d);
-							heap.decreaseKey(&label[m_length_b+k], temp_label);
-							backtrack[m_length_b+k] = i;
-						}
-					}
-				}
-			}
-			else {
-				k = alignment[i-m_length_b];
-				if (k >= 0 && label_free[k]) {
-					d = current_value - weight[k][i-m_length_b];
-					if (d < label[k].getKeyValue()) {
-						temp_label = label[k];
-						temp_label.setKeyValue(d);
-						heap.decreaseKey(&label[k], temp_label);
-						backtrack[k] = i;
-					}
-				}
-				if (match_free[i]) {
-					d = current_value + weight[m_length_b][i-m_length_b];
-					if (d < label_t) {
-						label_t = d;
-						backtrack_t = i;
-					}
-				}
-			}
-		}
-		while (min_label != NULL) {
-			min_label = (HeapNode *)heap.extractMin();
-		}
-		reduced_cost += label_t;
-		if (reduced_cost >= 0) break;
-		score += reduced_cost;
-
-		// Modify the weights
-		for (i=0; i<m_length_b; i++) {
-			for (j=0; j<active_num[i]; j++) {
-				k = active_index[i][j];
-				weight[i][k] += label[i].getKeyValue() - label[m_length_b+k].getKeyValue();
-			}
-		}
-		for (j=0; j<m_length_a; j++) {
-			weight[m_length_b][j] += label[m_length_b+j].getKeyValue() - label_t;
-		}
-
-		// Reverse path
-		k = backtrack_t;
-		while (k >= 0 && backtrack[k] >= 0) {
-			alignment[k-m_length_b] = backtrack[k];
-			match_free[k] = false;
-			k = backtrack[k];
-			match_free[k] = false;
-			k = backtrack[k];
-		}
-	}
-
-	delete[] label;
-	delete[] backtrack;
-	Matrix<int>::free(active_index);
-	delete[] active_num;
-	delete[] label_free;
-	delete[] match_free;
-	Matrix<double>::free(weight);
-
-	return score;
-}
-
-double PairAlign::solveMaxAlign(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda)
-{
-	double score, **weight, **score_matrix;
-	int **backtrack_b, **backtrack_a;
-	bool **align_matrix, match;
-	double d, dd, da, db;
-	int i, j, k;
-
-	weight = Matrix<double>::alloc(m_length_b, m_length_a);
-	score_matrix = Matrix<double>::alloc(m_length_b, m_length_a);
-	backtrack_b = Matrix<int>::alloc(m_length_b, m_length_a);
-	backtrack_a = Matrix<int>::alloc(m_length_b, m_length_a);
-	align_matrix = Matrix<bool>::alloc(m_length_b, m_length_a);
-
-	lambda = lambda * lambda;
-	double **matrix = m_chain_a->getMatrix(translation, rotation);
-	for (i=0; i<m_length_b; i++) {
-		for (j=0; j<m_length_a; j++) {
-			weight[i][j] = 0;
-			for (k=0; k<3; k++) {
-				d = matrix[j][k] - (*m_chain_b)[i][k];
-				weight[i][j] += d * d;
-			}
-			weight[i][j] -= lambda;
-		}
-	}
-	Matrix<double>::free(matrix);
-
-	if (weight[0][0] <= 0) {
-		score_matrix[0][0] = weight[0][0];
-		align_matrix[0][0] = true;
-	}
-	else {
-		score_matrix[0][0] = 0;
-		align_matrix[0][0] = false;
-	}
-	backtrack_b[0][0] = -1;
-	backtrack_a[0][0] = -1;
-	for (i=1; i<m_length_b; i++) {
-		if (weight[i][0] <= score_matrix[i-1][0]) {
-			score_matrix[i][0] = weight[i][0];
-			align_matrix[i][0] = true;
-			backtrack_b[i][0] = -1;
-			backtrack_a[i][0] = -1;
-		}
-		else {
-			score_matrix[i][0] = score_matrix[i-1][0];
-			align_matrix[i][0] = false;
-			backtrack_b[i][0] = i-1;
-			backtrack_a[i][0] = 0;
-		}
-	}
-	for (j=1; j<m_length_a; j++) {
-		if (weight[0][j] <= score_matrix[0][j]) {
-			score_matrix[0][j] = weight[0][j];
-			align_matrix[0][j] = true;
-			backtrack_b[0][j] = -1;
-			backtrack_a[0][j] = -1;
-		}
-		else {
-			score_matrix[0][j] = score_matrix[0][j-1];
-			align_matrix[0][j] = false;
-			backtrack_b[0][j] = 0;
-			backtrack_a[0][j] = j-1;
-		}
-	}
-
-	for (i=1; i<m_length_b; i++) {
-		for (j=1; j<m_length_a; j++) {
-			if (weight[i][j] <= 0) {
-				dd = score_matrix[i-1][j-1] + weight[i][j];
-				match = true;
-			}
-			else {
-				dd = score_matrix[i-1][j-1];
-				match = false;
-			}
-			da = score_matrix[i-1][j];
-			db = score_matrix[i][j-1];
-			if (dd <= da && dd <= db) {
-				score_matrix[i][j] = dd;
-				align_matrix[i][j] = match;
-				backtrack_b[i][j] = i-1;
-				backtrack_a[i][j] = j-1;
-			}
-			else if (da <= db) {
-				score_matrix[i][j] = da;
-				align_matrix[i][j] = false;
-				backtrack_b[i][j] = i-1;
-				backtrack_a[i][j] = j;
-			}
-			else {
-				score_matrix[i][j] = db;
-				align_matrix[i][j] = false;
-				backtrack_b[i][j] = i;
-				backtrack_a[i][j] = j-1;
-			}
-		}
-	}
-
-	for (i=0; i<m_length_a; i++) {
-		alignment[i] = -1;
-	}
-	i = m_length_b - 1;
-	j = m_length_a - 1;
-	score = score_matrix[i][j];
-	while (i >= 0 && j >= 0) {
-		if (align_matrix[i][j]) {
-			alignment[j] = i;
-		}
-		k = backtrack_b[i][j];
-		j = backtrack_a[i][j];
-		i = k;
-	}
-
-	Matrix<bool>::free(align_matrix);
-	Matrix<int>::free(backtrack_a);
-	Matrix<int>::free(backtrack_b);
-	Matrix<double>::free(score_matrix);
-	Matrix<double>::free(weight);
-
-	return score;
-}
-
-void PairAlign::writePDBFile(const string &filename) const
-{
-	FILE *fp;
-	char buffer[80];
-
-	if ((fp = fopen(filename.c_str(), "w")) == NULL) {
-		Logger::error("Can not open the file: %s\n", filename.c_str());
-		exit(1);
-	}
-
-	fprintf(fp, "HEADER    %-40s%30c\n", "PAIRWISE PROTEIN STRUCTURE ALIGNMENT", ' ');
-
-	strcpy(buffer, "ALIGNMENT RESULT OF ");
-	strcat(buffer, m_chain_a->raw_name());
-	strcat(buffer, " AND ");
-	strcat(buffer, m_chain_b->raw_name());
-	fprintf(fp, "TITLE     %-60s%10c\n", buffer, ' ');
-
-	m_chain_a->writePDBModel(fp, 1, true, m_translation, m_rotation);
-	m_chain_b->writePDBModel(fp, 2, true);
-
-	fprintf(fp, "END   %74c\n", ' ');
-
-	fclose(fp);
-}
-
-void PairAlign::writeSolutionFile(const string &filename) const
-{
-	FILE *fp;
-	int i, j;
-
-	if ((fp = fopen(filename.c_str(), "w")) == NULL) {
-		Logger::error("Can not open the file: %s\n", filename.c_str());
-		exit(1);
-	}
-
-	fprintf(fp, "[Abstact]\n");
-	fprintf(fp, "Alignment result of %s AND %s\n\n", m_chain_a->raw_name(), m_chain_b->raw_name());
-
-	fprintf(fp, "[Result]\n");
-	fprintf(fp, " %f %d\n\n", m_rmsd, m_align_num);
-
-	fprintf(fp, "[Alignment]\n");
-	for (i=0; i<m_length_a; i++) {
-		fprintf(fp, " %3d", m_alignment[i]);
-		if (i % 20 == 19) {
-			fprintf(fp, "\n");
-		}
-	}
-	fprintf(fp, "\n\n");
-	
-	fprintf(fp, "[Translation]\n");
-	for (i=0; i<3; i++) {
-		fprintf(fp, " %lf", m_translation[i]);
-	}
-	fprintf(fp, "\n\n");
-
-	fprintf(fp, "[Rotation]\n");
-	for (i=0; i<3; i++) {
-		for (j=0; j<3; j++) {
-			fprintf(fp, " %lf", m_rotation[i][j]);
-		}
-		fprintf(fp, "\n");
-	}
-	fprintf(fp, "\n");
-
-	fclose(fp);
-}
-
-int PairAlign::_getAlignNum(const vector<int> &alignment)
-{
-	int align_num, i;
-	align_num = 0;
-	for (i=0; i<m_length_a; i++) {
-		if (alignment[i] >= 0) {
-			align_num++;
-		}
-	}
-	return align_num;
-}
-
-int PairAlign::_getBreakNum(const vector<int> &alignment)
-{
-	int break_num, i;
-	bool in_break;
-	break_num = 0;
-	if (alignment[0] < 0) {
-		in_break = true;
-	}
-	else {
-		in_break = false;
-	}
-	for (i=1; i<m_length_a; i++) {
-		if (in_break) {
-			if (alignment[i] >= 0) in_break = false;
-		}
-		else if (alignment[i] < 0) {
-			in_break = true;
-			break_num++;
-		}
-		else if (alignment[i] != alignment[i-1]+1 && alignment[i] != alignment[i-1]-1) {
-			break_num++;
-		}
-	}
-	if (in_break && break_num > 0) break_num--;
-	return break_num;
-}
-
-int PairAlign::_getPermuNum(const vector<int> &alignment)
-{
-	int permu_num, i, j;
-	permu_num = 0;
-	j = -1;
-	for (i=0; i<m_length_a; i++) {
-		if (alignment[i] >= 0) {
-			if (alignment[i] < j) {
-				permu_num++;
-			}
-			j = alignment[i];
-		}
-	}
-	return permu_num;
-}
-
-double PairAlign::_getSequenceIdentity(const vector<int> &alignment)
-{
-	int i, s, n;
-	double sequence_identity;
-	s = 0;
-	n = 0;
-	for (i=0; i<m_length_a; i++) {
-		if (alignment[i] >= 0) {
-			if ((*m_chain_a)[i].isIdenticalResidue((*m_chain_b)[alignment[i]])) s++;
-			n++;
-		}
-	}
-	sequence_identity = (double)s / n;
-	return sequence_identity;
-}
+
+#include <map>
+#include <deque>
+#include <queue>
+#include <numeric>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/detail/atomic_count.hpp>
+
+#include "Utils.h"
+#include "Matrix.h"
+#include "PairAlign.h"
+#include "Superposition.h"
+#include "FibHeap.h"
+#include "DaryHeap.h"
+#include "SpatialGrid.h"
+
+#include "MemLeak.h"
+
+
+#define square(d) ((d)*(d))
+#define get_square_distance(x, y) (square((x)[0]-(y)[0])+square((x)[1]-(y)[1])+square((x)[2]-(y)[2]))
+#define get_distance(x, y) sqrt(get_square_distance(x, y))
+#define get_outer_distance(x, y, i, j) get_distance((x)[i], (y)[j])
+#define get_inner_distance(x, i, j) get_distance((x)[i], (x)[j])
+
+
+////////////////////////////////
+//
+// class PairAlign
+
+PairAlign::PairAlign(ProteinChain *chain_a, ProteinChain *chain_b)
+{
+	int i, j;
+	m_chain_a = chain_a;
+	m_chain_b = chain_b;
+	m_truncated = false;
+	for (i=0; i<3; i++) {
+		m_translation[i] = 0;
+		for (j=0; j<3; j++) {
+			m_rotation[i][j] = 0;
+		}
+		m_rotation[i][i] = 1.0;
+	}
+	if (m_chain_a != NULL) {
+		m_length_a = m_chain_a->length();
+		m_alignment.resize(m_length_a, -1);
+	}
+	if (m_chain_b != NULL) {
+		m_length_b = m_chain_b->length();
+	}
+}
+
+void PairAlign::setChain(int i, ProteinChain *chain)
+{
+	if (i == 0) {
+		m_chain_a = chain;
+		if (m_chain_a != NULL && m_length_a != m_chain_a->length()) {
+			m_length_a = m_chain_a->length();
+			m_alignment.resize(m_length_a);
+		}
+	}
+	else {
+		m_chain_b = chain;
+		if (m_chain_b != NULL && m_length_b != m_chain_b->length()) {
+			m_length_b = m_chain_b->length();
+		}
+	}
+}
+
+double PairAlign::align()
+{
+	m_align_num = 0;
+	m_break_num = 0;
+	m_permu_num = 0;
+	m_sequence_identity = 0;
+	m_rmsd = 0;
+	if (m_length_a == 0 || m_length_b == 0)
+	{
+		Logger::warning("Attmpt to align empty chain!");
+		return m_rmsd;
+	}
+	m_truncated = false;
+	if (m_params.time_limit > 0) {
+		m_deadline = boost::posix_time::microsec_clock::universal_time()
+			+ boost::posix_time::microseconds((boost::int64_t) (m_params.time_limit * 1e6));
+	}
+	initWeights();
+	if (m_params.branch_and_bound) {
+		alignBNB();
+	}
+	else {
+		alignITER();
+	}
+	if (m_truncated) {
+		Logger::warning("Time limit of %g seconds reached, the best solution so far is kept!", m_params.time_limit);
+	}
+	if (m_params.validate && m_params.single_precision) {
+		_validate();
+	}
+
+// 	m_chain_a->writeChainCode(stderr);
+// 	Logger::info("");
+// 
+// 	for (int i=0; i<m_length_a; i++) {
+// 		if (m_alignment[i] >= 0) fprintf(stderr, "%c", (*m_chain_b)[m_alignment[i]].resCode());
+// 		else fprintf(stderr, "%c", '.');
+// 	}
+// 	Logger::info("");
+// 
+// 	m_chain_b->writeChainCode(stderr);
+// 	Logger::info("");
+
+	return m_rmsd;
+}
+
+// solve the final matching again with weights in double precision, and report
+// how far the single precision result is from it
+
+void PairAlign::_validate()
+{
+	double translation[3], rotation[3][3], score_single, score_double;
+	vector<int> alignment_single(m_alignment), alignment_double(m_alignment);
+	int i, j, diff_num;
+
+	for (i=0; i<3; i++) {
+		translation[i] = m_translation[i];
+		for (j=0; j<3; j++) {
+			rotation[i][j] = m_rotation[i][j];
+		}
+	}
+	score_single = solveMaxMatch(translation, rotation, alignment_single, m_params.lambda);
+
+	m_params.single_precision = false;
+	initWeights();
+	score_double = solveMaxMatch(translation, rotation, alignment_double, m_params.lambda);
+	m_weights.resize(0, 0);
+	m_params.single_precision = true;
+
+	diff_num = 0;
+	for (i=0; i<m_length_a; i++) {
+		if (alignment_single[i] != alignment_double[i]) diff_num++;
+	}
+	Logger::info("Validate: single score = %f, double score = %f, %d residues aligned differently",
+		score_single, score_double, diff_num);
+}
+
+// The search tree of branch and bound is shared by the threads of a pool. Every
+// branch of the first residue is a task, and a worker takes the newest task of
+// its own and steals the oldest task of others. While other workers wait, a
+// worker hands over the untried branches of the shallowest residue of its
+// current task. Idle workers sleep until a task is pushed or the last one is
+// done. The incumbent is shared, and every worker prunes by its own copy of the
+// best score, which is refreshed under the lock when a task is taken and every
+// few hundred nodes. With one thread the search runs in the serial order.
+
+struct BNBTask {
+	vector<int> alignment;							// Residues before index are fixed
+	int index;										// Residue of the branch to search
+};
+
+struct BNBSearch {
+	struct Worker {
+		deque<BNBTask> tasks;
+		boost::mutex mutex;
+		double best_score;							// Copy of the incumbent score, used by the worker alone
+	};
+
+	Worker *workers;
+	int worker_num;
+	int pending;									// Number of tasks queued or running
+	int pushed;										// Number of tasks pushed, to tell waiters of new ones
+	boost::detail::atomic_count hungry;				// Number of workers waiting for tasks
+	double best_score;								// Score of the incumbent
+	boost::mutex mutex;								// Guards pending, pushed, hungry and the incumbent
+	boost::condition_variable changed;				// Signals a pushed task or no pending task
+	DenseMatrix<double> distance_a, distance_b;		// Inner distances of the chains
+
+	BNBSearch(int n) : hungry(0) { workers = new Worker [n]; worker_num = n; pending = 0; pushed = 0; best_score = 0; }
+	~BNBSearch() { delete[] workers; }
+
+	void push(int worker, const BNBTask &task);
+	bool pop(int worker, BNBTask &task);
+	void done();
+	bool starving(int worker);
+};
+
+// the task is counted before it can be taken, so pending never drops to zero
+// while a task is queued
+
+void BNBSearch::push(int worker, const BNBTask &task)
+{
+	boost::mutex::scoped_lock lock(mutex);
+	pending++;
+	{
+		boost::mutex::scoped_lock worker_lock(workers[worker].mutex);
+		workers[worker].tasks.push_back(task);
+	}
+	pushed++;
+	if (hungry > 0) changed.notify_all();
+}
+
+// take a task and refresh the copy of the incumbent score, and sleep while
+// other workers may still create tasks
+
+bool BNBSearch::pop(int worker, BNBTask &task)
+{
+	bool waiting;
+	int i, k, version;
+
+	waiting = false;
+	while (true) {
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			version = pushed;
+		}
+		for (i=0; i<worker_num; i++) {
+			k = (worker + i) % worker_num;
+			boost::mutex::scoped_lock lock(workers[k].mutex);
+			if (workers[k].tasks.empty()) continue;
+			if (k == worker) {
+				task = workers[k].tasks.back();
+				workers[k].tasks.pop_back();
+			}
+			else {
+				task = workers[k].tasks.front();
+				workers[k].tasks.pop_front();
+			}
+			break;
+		}
+		{
+			boost::mutex::scoped_lock lock(mutex);
+			if (i < worker_num || pending == 0) {
+				if (waiting) --hungry;
+				workers[worker].best_score = best_score;
+				return i < worker_num;
+			}
+			if (!waiting) {
+				++hungry;
+				waiting = true;
+			}
+			// a task pushed since the scan is taken without sleeping
+			while (pushed == version && pending > 0) changed.wait(lock);
+		}
+	}
+}
+
+void BNBSearch::done()
+{
+	boost::mutex::scoped_lock lock(mutex);
+	if (--pending == 0) changed.notify_all();
+}
+
+// whether some worker waits and there is nothing left to steal from this one,
+// hungry is read atomically as a hint
+
+bool BNBSearch::starving(int worker)
+{
+	if (hungry == 0) return false;
+	boost::mutex::scoped_lock lock(workers[worker].mutex);
+	return workers[worker].tasks.empty();
+}
+
+double PairAlign::alignBNB()
+{
+	BNBTask task;
+	int worker_num, i;
+
+	alignITER();
+
+	m_pool.setThreadNum(m_params.thread_num);
+	worker_num = m_pool.thread_num();
+	BNBSearch search(worker_num);
+	search.best_score = m_score;
+	_getInnerDistance(*m_chain_a, search.distance_a);
+	_getInnerDistance(*m_chain_b, search.distance_b);
+
+	// the branches of the first residue, in reverse order as workers take the
+	// newest task first
+	task.alignment.assign(m_length_a, -1);
+	task.index = 0;
+	for (i=m_length_b; i>=0; i--) {
+		task.alignment[0] = (i < m_length_b) ? i : -2;
+		search.push(i % worker_num, task);
+	}
+	m_pool.run(worker_num, boost::bind(&PairAlign::_searchBNB, this, &search, _1));
+
+	return m_rmsd;
+}
+
+void PairAlign::_searchBNB(BNBSearch *search, int worker)
+{
+	BNBTask task;
+	while (search->pop(worker, task)) {
+		// after the time limit the tasks left are dropped
+		if (!_timeout()) _branchBNB(search, worker, task);
+		search->done();
+	}
+}
+
+// Depth first search of the subtree of a task. levels[k] holds the moments of the
+// pairs of residues before k, so a branch adds one pair to a copy of its parent
+// and costs the same for chains of any length. branches[k] holds the branches of
+// residue k to try, and next[k] is the next one of them, a residue marked as
+// donated has no more branches to try here.
+//
+// The pairs are superposed evenly, so the superposition minimizes the score of
+// the aligned pairs, and both bounds below hold for the best superposition of
+// every alignment. Pairs beyond lambda add to the score, so in an optimal
+// alignment every pair is within lambda after superposition, and the inner
+// distances of two pairs differ by less than 2 lambda. Branches breaking this with an aligned pair are never
+// tried, and the others are tried nearest first under the superposition of the
+// aligned pairs, so good incumbents are found early. Each further pair lowers the
+// score by at most lambda^2, and there are no more of them than residues left in
+// either chain.
+
+void PairAlign::_branchBNB(BNBSearch *search, int worker, BNBTask &task)
+{
+	double translation[3], rotation[3][3], lambda2, rmsd, score;
+	double &best_score = search->workers[worker].best_score;
+	vector<int> &alignment = task.alignment;
+	vector<bool> occupied(m_length_b, false), donated(m_length_a, false);
+	vector<Superposition> levels(m_length_a+1);
+	vector<vector<int> > branches(m_length_a);
+	vector<int> next(m_length_a);
+	int base, index, align_num, future_num, node_num, i;
+	bool descend, incumbent;
+
+	lambda2 = m_params.lambda * m_params.lambda;
+
+	base = task.index;
+	for (i=0; i<base; i++) {
+		if (alignment[i] >= 0) {
+			occupied[alignment[i]] = true;
+			_addPair(levels[base], i, alignment[i], false);
+		}
+	}
+
+	index = base;
+	i = alignment[base];
+	node_num = 0;
+	while (true) {
+		if (++node_num % 256 == 0) {
+			if (_timeout()) break;
+			boost::mutex::scoped_lock lock(search->mutex);
+			best_score = search->best_score;
+		}
+		levels[index+1] = levels[index];
+		descend = (index < m_length_a-1);
+		if (i >= 0) {
+			occupied[i] = true;
+			_addPair(levels[index+1], index, i, false);
+			// test branch
+			align_num = levels[index+1].num();
+			if (levels[index+1].solve(translation, rotation)) {
+				rmsd = levels[index+1].rmsd(translation, rotation);
+				score = (rmsd * rmsd - lambda2) * align_num;
+				// the copy of the incumbent score is never below it, so a stale
+				// copy prunes less
+				incumbent = false;
+				if (score < best_score) {
+					boost::mutex::scoped_lock lock(search->mutex);
+					incumbent = (score < m_score);
+					if (incumbent) {
+						// incumbent, candidate of best solution
+						m_score = score;
+						m_align_num = align_num;
+						m_rmsd = rmsd;
+						setSolution(translation, rotation, alignment);
+						search->best_score = score;
+						Logger::debug("\tScore: %f, Aligned: %d, RMSD: %f", score, align_num, rmsd);
+					}
+					best_score = m_score;
+				}
+				future_num = min(m_length_a-index-1, m_length_b-align_num);
+				if (!incumbent && score-lambda2*future_num >= best_score) {
+					// bad branch, pruning
+					descend = false;
+				}
+			}
+		}
+		if (descend) {
+			// go on, next position
+			index++;
+			_getBranches(search, alignment, occupied, levels[index], index, branches[index]);
+			next[index] = 0;
+			if (search->worker_num > 1 && search->starving(worker)) {
+				_donateBNB(search, worker, alignment, index, branches, next, donated);
+			}
+		}
+		else {
+			if (alignment[index] >= 0) occupied[alignment[index]] = false;
+			alignment[index] = -1;
+		}
+		// backtracking over residues without branches left
+		while (index > base && (donated[index] || next[index] >= (int) branches[index].size())) {
+			donated[index] = false;
+			index--;
+			if (alignment[index] >= 0) occupied[alignment[index]] = false;
+			alignment[index] = -1;
+		}
+		if (index == base) break;
+		i = branches[index][next[index]++];
+		alignment[index] = i;
+	}
+}
+
+// branches of residue index, the residues of chain b compatible with all aligned
+// pairs nearest first, and then -2 for leaving it unaligned. Less than three
+// aligned pairs do not fix a superposition, and then the residues are ordered by
+// the differences of inner distances instead.
+
+void PairAlign::_getBranches(BNBSearch *search, const vector<int> &alignment, const vector<bool> &occupied,
+							 const Superposition &superposition, int index, vector<int> &branches)
+{
+	double translation[3], rotation[3][3], point[3], limit, d, diff;
+	vector<pair<double, int> > order;
+	vector<int> aligned;
+	bool superposed;
+	int i, j, k, p;
+
+	limit = 2 * m_params.lambda;
+	for (p=0; p<index; p++) {
+		if (alignment[p] >= 0) aligned.push_back(p);
+	}
+	superposed = (aligned.size() >= 3);
+	if (superposed) {
+		superposition.solve(translation, rotation);
+		for (i=0; i<3; i++) {
+			point[i] = translation[i];
+			for (k=0; k<3; k++) {
+				point[i] += rotation[i][k] * m_chain_a->coords(k)[index];
+			}
+		}
+	}
+
+	for (j=0; j<m_length_b; j++) {
+		if (occupied[j]) continue;
+		d = 0;
+		for (k=0; k<(int) aligned.size(); k++) {
+			p = aligned[k];
+			diff = fabs(search->distance_a[index][p] - search->distance_b[j][alignment[p]]);
+			if (diff >= limit) break;
+			d += diff;
+		}
+		if (k < (int) aligned.size()) continue;
+		if (superposed) {
+			d = 0;
+			for (i=0; i<3; i++) {
+				d += square(point[i] - m_chain_b->coords(i)[j]);
+			}
+		}
+		order.push_back(make_pair(d, j));
+	}
+	sort(order.begin(), order.end());
+
+	branches.clear();
+	for (k=0; k<(int) order.size(); k++) {
+		branches.push_back(order[k].second);
+	}
+	branches.push_back(-2);
+}
+
+// hand the untried branches of the shallowest residue which has any over to
+// the deque of the worker, where waiting workers steal them, the last residues
+// are not worth a task
+
+void PairAlign::_donateBNB(BNBSearch *search, int worker, const vector<int> &alignment, int index,
+						   const vector<vector<int> > &branches, const vector<int> &next, vector<bool> &donated)
+{
+	BNBTask task;
+	int p, k;
+
+	for (p=0; p<=index && p<m_length_a-2; p++) {
+		if (!donated[p] && next[p] < (int) branches[p].size()) break;
+	}
+	if (p > index || p >= m_length_a-2) return;
+
+	task.alignment.assign(alignment.begin(), alignment.begin()+p);
+	task.alignment.resize(m_length_a, -1);
+	task.index = p;
+	for (k=branches[p].size()-1; k>=next[p]; k--) {
+		task.alignment[p] = branches[p][k];
+		search->push(worker, task);
+	}
+	donated[p] = true;
+}
+
+double PairAlign::alignITER()
+{
+	vector<AlignSolution> solutions;
+	vector<int> alignment(m_length_a), starts, racing;
+	vector<pair<double, int> > ranks;
+	int survivor_num, stage, i;
+
+	m_score = HUGE_VAL;
+	m_pool.setThreadNum(m_params.thread_num);
+	initSeeds();
+	while (getStart(solutions.size(), alignment)) {
+		solutions.push_back(AlignSolution());
+		solutions.back().alignment = alignment;
+		starts.push_back(starts.size());
+	}
+
+	// starts are independent, so they may run concurrently; the best one is
+	// picked afterwards in start order to give the same result as a serial run
+
+	// successive halving: all starts in the race run a few rounds, then the
+	// worse half by the score of their current superposition is dropped
+	survivor_num = max(m_params.race_survivors, 1);
+	stage = 0;
+	while (m_params.race_rounds > 0 && (int) starts.size() > survivor_num) {
+		m_pool.run(starts.size(), boost::bind(&PairAlign::_alignStart, this, boost::ref(solutions), boost::cref(starts), m_params.race_rounds, _1));
+		ranks.clear();
+		for (i=0; i<(int) starts.size(); i++) {
+			AlignSolution &solution = solutions[starts[i]];
+			if (!solution.skipped && !solution.finished) {
+				ranks.push_back(make_pair(solution.race_score, starts[i]));
+			}
+		}
+		sort(ranks.begin(), ranks.end());
+		racing.clear();
+		for (i=0; i<(int) ranks.size(); i++) {
+			if (i < max((int) (ranks.size() + 1) / 2, survivor_num)) {
+				racing.push_back(ranks[i].second);
+			}
+			else {
+				solutions[ranks[i].second].dropped = true;
+			}
+		}
+		Logger::info("Race stage %d: %d starts finished, %d of %d running starts survived", ++stage,
+			(int) (starts.size() - ranks.size()), (int) racing.size(), (int) ranks.size());
+		sort(racing.begin(), racing.end());
+		starts.swap(racing);
+	}
+	m_pool.run(starts.size(), boost::bind(&PairAlign::_alignStart, this, boost::ref(solutions), boost::cref(starts), 0, _1));
+
+	for (i=0; i<(int) solutions.size(); i++) {
+		if (solutions[i].skipped) {
+			Logger::info("\tSkipped");
+			Logger::info("===============================================================================");
+			continue;
+		}
+		if (solutions[i].dropped) {
+			Logger::info("\tDropped, Score: %f", solutions[i].race_score);
+			Logger::info("===============================================================================");
+			continue;
+		}
+		Logger::info("\tInitial solution: %f", solutions[i].initial_rmsd);
+		Logger::info("\tScore: %f, Aligned: %d, RMSD: %f", solutions[i].score, solutions[i].align_num, solutions[i].rmsd);
+		Logger::info("===============================================================================");
+		if (solutions[i].score < m_score) {
+			m_score = solutions[i].score;
+			m_align_num = solutions[i].align_num;
+			m_rmsd = solutions[i].rmsd;
+			setSolution(solutions[i].translation, solutions[i].rotation, solutions[i].alignment);
+		}
+	}
+
+	return m_rmsd;
+}
+
+double PairAlign::continueAlign()
+{
+	double score_old, score_new;
+	vector<double> potential;
+	score_new = HUGE_VAL;
+	do {
+		score_old = score_new;
+		solveLeastSquare(m_translation, m_rotation, m_alignment);
+		score_new = solveMaxMatch(m_translation, m_rotation, m_alignment, m_params.lambda, &potential);
+	} while (fabs(score_new - score_old) > 0.01);
+	m_align_num = _getAlignNum(m_alignment);
+	m_rmsd = m_chain_a->getRMSD(*m_chain_b, m_translation, m_rotation, m_alignment);
+	return m_rmsd;
+}
+
+void PairAlign::postProcess()
+{
+	postAlign();
+	m_break_num = _getBreakNum(m_alignment);
+	m_permu_num = _getPermuNum(m_alignment);
+	Logger::info("PairAlign: %s (size=%d) vs %s (size=%d)\n\tAligned = %d, RMSD = %f\n\tBreak/Permutation = %d/%d, SeqId = %5.3f",
+		m_chain_a->raw_name(), m_length_a, m_chain_b->raw_name(), m_length_b,
+		m_align_num, m_rmsd, m_break_num, m_permu_num, _getSequenceIdentity(m_alignment));
+
+	if (m_params.sequential_order) {
+		postAlign(true);
+		Logger::info("PostAlign: %s (size=%d) vs %s (size=%d)\n\tAligned = %d, RMSD = %f\n\tBreak/Permutation = %d/%d, SeqId = %5.3f",
+			m_chain_a->raw_name(), m_length_a, m_chain_b->raw_name(), m_length_b,
+			m_align_num, m_rmsd, m_break_num, m_permu_num, _getSequenceIdentity(m_alignment));
+	}
+}
+
+double PairAlign::postAlign(bool seq_order)
+{
+	if (m_params.single_precision) {
+		_fillWeights(m_weights_single, 1.0f);
+	}
+	else {
+		_fillWeights(m_weights, 1.0);
+	}
+	if (seq_order) {
+		solveMaxAlign(m_translation, m_rotation, m_alignment, m_params.lambda);
+	}
+	else {
+		solveMaxMatch(m_translation, m_rotation, m_alignment, m_params.lambda);
+	}
+	m_align_num = _getAlignNum(m_alignment);
+	m_rmsd = m_chain_a->getRMSD(*m_chain_b, m_translation, m_rotation, m_alignment);
+	m_break_num = _getBreakNum(m_alignment);
+	m_permu_num = _getPermuNum(m_alignment);
+	return m_rmsd;
+}
+
+bool PairAlign::getStart(int index, vector<int> &alignment)
+{
+	int i, j, k;
+	int block_length, block_number_a, block_number_b;
+	int block_a, block_b;
+
+	for (k=0; k<m_length_a; k++) {
+		alignment[k] = -1;
+	}
+	if (!m_seeds.empty()) {
+		if (index < (int) m_seeds.size()) {
+			for (k=0; k<m_params.fragment_length; k++) {
+				alignment[m_seeds[index].first + k] = m_seeds[index].second + k;
+			}
+			return true;
+		}
+	}
+	else if (m_params.heuristic_start > 0) {
+		block_length = (max(m_length_a, m_length_b) + m_params.heuristic_start - 1) / m_params.heuristic_start;
+		block_number_a = (m_length_a + block_length - 1) / block_length;
+		block_number_b = (m_length_b + block_length - 1) / block_length;
+
+		block_a = index / block_number_b;
+		block_b = index % block_number_b;
+
+		if (block_a < block_number_a) {
+			for (k=0; k<block_length; k++) {
+				i = block_a * block_length + k;
+				j = block_b * block_length + k;
+				if (i < m_length_a && j < m_length_b) {
+					alignment[i] = j;
+				}
+			}
+			return true;
+		}
+	}
+	else {
+		if (index == 0) {
+			for (k=0; k<m_length_a; k++) {
+				alignment[k] = k;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+// Seeds by fragment hashing. A fragment of f residues is described by the
+// distances between its first, middle and last residues, quantized into bins,
+// and fragments of chain b are hashed by these keys. Fragments of chain a look
+// up their own and the neighboring bins. The pairs found are ranked by the
+// distances between their keys, only the closest 64 per seed of the budget are
+// kept, and those are ranked by the similarity of their full distance matrices. The pairs are taken in order,
+// skipping those whose superposition is close to one taken, until the budget
+// is used up. Without any pair the grid of heuristic levels is used.
+
+void PairAlign::initSeeds()
+{
+	vector<vector<double> > band_a, band_b;
+	map<int, vector<int> > buckets;
+	map<int, vector<int> >::const_iterator bucket;
+	priority_queue<pair<double, pair<int, int> > > hits;
+	vector<pair<double, pair<int, int> > > candidates;
+	vector<double> centers;
+	vector<double> rotations;
+	Superposition superposition;
+	double translation[3], rotation[3][3], center_a[3], center[3], x[3], y[3], d, r;
+	int num_a, num_b, f, key, limit, i, j, k, l, m;
+
+	m_seeds.clear();
+	f = m_params.fragment_length;
+	limit = 64 * m_params.seed_budget;
+	num_a = m_length_a - f + 1;
+	num_b = m_length_b - f + 1;
+	if (m_params.seed_method != "fragment" || f < 3 || limit <= 0 || num_a <= 0 || num_b <= 0) return;
+
+	_getBandDistance(*m_chain_a, f, band_a);
+	_getBandDistance(*m_chain_b, f, band_b);
+	for (j=0; j<num_b; j++) {
+		buckets[_getFragmentKey(band_b, j, f, 13)].push_back(j);
+	}
+	for (i=0; i<num_a; i++) {
+		for (k=0; k<27; k++) {
+			key = _getFragmentKey(band_a, i, f, k);
+			if (key < 0 || (bucket = buckets.find(key)) == buckets.end()) continue;
+			for (l=0; l<(int) bucket->second.size(); l++) {
+				j = bucket->second[l];
+				d = _getKeyDistance(band_a, band_b, i, j, f);
+				if ((int) hits.size() < limit) {
+					hits.push(make_pair(d, make_pair(i, j)));
+				}
+				else if (d < hits.top().first) {
+					hits.pop();
+					hits.push(make_pair(d, make_pair(i, j)));
+				}
+			}
+		}
+	}
+	for (; !hits.empty(); hits.pop()) {
+		i = hits.top().second.first;
+		j = hits.top().second.second;
+		candidates.push_back(make_pair(_getFragmentDistance(band_a, band_b, i, j, f), make_pair(i, j)));
+	}
+	sort(candidates.begin(), candidates.end());
+
+	for (k=0; k<3; k++) {
+		center_a[k] = 0;
+		for (i=0; i<m_length_a; i++) {
+			center_a[k] += m_chain_a->coords(k)[i];
+		}
+		center_a[k] /= m_length_a;
+	}
+	for (m=0; m<(int) candidates.size() && (int) m_seeds.size()<m_params.seed_budget; m++) {
+		i = candidates[m].second.first;
+		j = candidates[m].second.second;
+		superposition.clear();
+		for (l=0; l<f; l++) {
+			for (k=0; k<3; k++) {
+				x[k] = m_chain_a->coords(k)[i+l];
+				y[k] = m_chain_b->coords(k)[j+l];
+			}
+			superposition.add(x, y);
+		}
+		superposition.solve(translation, rotation);
+		for (k=0; k<3; k++) {
+			center[k] = translation[k];
+			for (l=0; l<3; l++) {
+				center[k] += rotation[k][l] * center_a[l];
+			}
+		}
+		// a superposition moving the center of chain a by less than 4A and
+		// rotating by less than about 20 degrees from a seed is a duplicate
+		for (l=0; l<(int) m_seeds.size(); l++) {
+			d = r = 0;
+			for (k=0; k<3; k++) {
+				d += square(center[k] - centers[3*l+k]);
+				r += square(rotation[k][0] - rotations[9*l+3*k]) + square(rotation[k][1] - rotations[9*l+3*k+1])
+					+ square(rotation[k][2] - rotations[9*l+3*k+2]);
+			}
+			if (d < 16.0 && r < 0.25) break;
+		}
+		if (l < (int) m_seeds.size()) continue;
+		m_seeds.push_back(make_pair(i, j));
+		centers.insert(centers.end(), center, center + 3);
+		for (k=0; k<3; k++) {
+			rotations.insert(rotations.end(), rotation[k], rotation[k] + 3);
+		}
+	}
+	Logger::debug("Fragment seeds: %d of %d candidate pairs", (int) m_seeds.size(), (int) candidates.size());
+}
+
+void PairAlign::initWeights()
+{
+	if (m_params.single_precision) {
+		_initWeights(m_weights_single);
+	}
+	else {
+		_initWeights(m_weights);
+	}
+}
+
+template <class Real>
+void PairAlign::_initWeights(DenseMatrix<Real> &weights)
+{
+	int i, j, k, f;
+	int num_a, num_b;
+	double s, max_s;
+	vector<vector<double> > band_a, band_b;
+	vector<double> prev, next, delta;
+
+	_fillWeights(weights, (Real) 0);
+
+	// init weights by local structure
+
+	// using distance matrix to setup initial solutions
+
+	f = m_params.fragment_length;
+	num_a = m_length_a - f + 1;
+	num_b = m_length_b - f + 1;
+	if (m_params.weight_method == "LS" && num_a > 0 && num_b > 0) {
+		// the similarity of fragments i and j sums |A(i+k, i+l) - B(j+k, j+l)|
+		// for k, l < f, only inner distances within f-1 residues are needed
+		_getBandDistance(*m_chain_a, f, band_a);
+		_getBandDistance(*m_chain_b, f, band_b);
+
+		// the fragment pair (i+1, j+1) shares all but the first row and column
+		// of its terms with (i, j), and by symmetry both are the same sum, so
+		// s(i+1, j+1) = s(i, j) - 2 * sum |A(i, i+l) - B(j, j+l)|
+		//                       + 2 * sum |A(i+f, i+l) - B(j+f, j+l)|, 0 < l < f
+		// the sums on the first row and column are computed in full, and the
+		// rows are kept in double precision whatever the type of weights
+		prev.resize(num_b);
+		next.resize(num_b);
+		delta.resize(num_b);
+		max_s = 0;
+		for (i=0; i<num_a; ++i) {
+			if (i == 0) {
+				for (j=0; j<num_b; ++j) {
+					next[j] = _getFragmentDistance(band_a, band_b, 0, j, f);
+				}
+			}
+			else {
+				for (j=0; j+1<num_b; ++j) {
+					delta[j] = 0;
+				}
+				for (k=1; k<f; k++) {
+					_addBandDistance(band_a[k][i-1], &band_b[k][0], -2.0, &delta[0], num_b-1);
+					_addBandDistance(band_a[k][i-1+f-k], &band_b[k][f-k], 2.0, &delta[0], num_b-1);
+				}
+				next[0] = _getFragmentDistance(band_a, band_b, i, 0, f);
+				for (j=0; j+1<num_b; ++j) {
+					next[j+1] = max(prev[j] + delta[j], 0.0);
+				}
+			}
+			for (j=0; j<num_b; ++j) {
+				s = next[j] / (f * f);
+				weights[j][i] = s;
+				max_s = max(s, max_s);
+			}
+			prev.swap(next);
+		}
+
+		for (i=0; i<num_a; ++i) {
+			for (j=0; j<num_b; ++j) {
+ 				weights[j][i] = (max_s - weights[j][i]) / max_s;
+			}
+		}
+	}
+
+	// init weights by sequence identity
+// 	for (i=0; i<m_length_a; ++i) {
+// 		for (j=0; j<m_length_b; ++j) {
+// 			if ((*m_chain_a)[i].resCode() == (*m_chain_b)[j].resCode()) {
+// 				m_weights[i][j] = 1.0;
+// 			}
+// 			else {
+// 				m_weights[i][j] = 0;
+// 			}
+// 		}
+// 	}
+}
+
+void PairAlign::benchmark(int repeat)
+{
+	double translation[3], rotation[3][3], score_old, score_new;
+	vector<int> alignment(m_length_a);
+	const char *queues[] = { "dary", "fib" };
+	string priority_queue;
+	bool warm_start;
+	Timer timer;
+	int i, j;
+
+	// converge from the first start, so that the matching problems have the
+	// size of real alignments
+	initWeights();
+	getStart(0, alignment);
+	score_new = HUGE_VAL;
+	do {
+		score_old = score_new;
+		solveLeastSquare(translation, rotation, alignment);
+		score_new = solveMaxMatch(translation, rotation, alignment, m_params.lambda);
+	} while (score_new < score_old && fabs(score_new - score_old) > 0.01);
+	Logger::info("Benchmark: %s (size=%d) vs %s (size=%d), Aligned = %d",
+		m_chain_a->raw_name(), m_length_a, m_chain_b->raw_name(), m_length_b, _getAlignNum(alignment));
+
+	// repeated runs on the same problem are trivial for a warm start
+	priority_queue = m_params.priority_queue;
+	warm_start = m_params.warm_start;
+	m_params.warm_start = false;
+	for (i=0; i<2; i++) {
+		m_params.priority_queue = queues[i];
+		timer.begin(queues[i]);
+		for (j=0; j<repeat; j++) {
+			score_new = solveMaxMatch(translation, rotation, alignment, m_params.lambda);
+		}
+		timer.end();
+		Logger::info("\t%-4s: %f seconds for %d runs, Score = %f", queues[i], timer.time(), repeat, score_new);
+	}
+	m_params.priority_queue = priority_queue;
+	m_params.warm_start = warm_start;
+}
+
+double PairAlign::evaluate(const string &filename)
+{
+	FILE *fp;
+	char buffer[100];
+	int i, j;
+	bool has_alignment, has_tranlation, has_rotation;
+
+	has_alignment = false;
+	has_tranlation = false;
+	has_rotation = false;
+
+	for (i=0; i<m_length_a; i++) {
+		m_alignment[i] = -1;
+	}
+	for (i=0; i<3; i++) {
+		m_translation[i] = 0;
+		for (j=0; j<3; j++) {
+			m_rotation[i][j] = 0;
+		}
+		m_rotation[i][i] = 1.0;
+	}
+
+	if ((fp = fopen(filename.c_str(), "r")) == NULL) {
+		Logger::error("Can not open the file: %s\n", filename.c_str());
+		exit(1);
+	}
+
+	while (!feof(fp)) {
+		fgets(buffer, 100, fp);
+
+		if (strncmp(buffer, "[Alignment]", 11) == 0) {
+			for (i=0; i<m_length_a; i++) {
+				fscanf(fp, "%d", &m_alignment[i]);
+			}
+			has_alignment = true;
+		}
+		else if (strncmp(buffer, "[Translation]", 13) == 0) {
+			for (i=0; i<3; i++) {
+				fscanf(fp, "%lf", &m_translation[i]);
+			}
+			has_tranlation = true;
+		}
+		else if (strncmp(buffer, "[Rotation]", 10) == 0) {
+			for (i=0; i<3; i++) {
+				for (j=0; j<3; j++) {
+					fscanf(fp, "%lf", &m_rotation[i][j]);
+				}
+			}
+			has_rotation = true;
+		}
+	}
+	
+	fclose(fp);
+
+	initWeights();
+	if (has_alignment) {
+		solveLeastSquare(m_translation, m_rotation, m_alignment);
+	}
+	else if (has_tranlation && has_rotation) {
+		solveMaxMatch(m_translation, m_rotation, m_alignment, m_params.lambda);
+	}
+	else if (has_tranlation) {
+		Logger::error("Rotation matrix is missing!");
+		exit(1);
+	}
+	else {
+		Logger::error("Translation matrix is missing!");
+		exit(1);
+	}
+
+	m_align_num = _getAlignNum(m_alignment);
+	m_rmsd = m_chain_a->getRMSD(*m_chain_b, m_translation, m_rotation, m_alignment);
+	Logger::debug("\tEvaluated: %d, RMSD: %f", m_align_num, m_rmsd);
+
+	return m_rmsd;
+}
+
+double PairAlign::improve(const string &filename)
+{
+	double score_old, score_new;
+	vector<double> potential;
+
+	evaluate(filename);
+	score_new = HUGE_VAL;
+	do {
+		score_old = score_new;
+		solveLeastSquare(m_translation, m_rotation, m_alignment);
+		score_new = solveMaxMatch(m_translation, m_rotation, m_alignment, m_params.lambda, &potential);
+		Logger::debug("\t%f", score_new);
+		if (score_new > score_old) {
+			Logger::warning("Not convergent!");
+			break;
+		}
+	} while (fabs(score_new - score_old) > 0.01);
+	solveMaxMatch(m_translation, m_rotation, m_alignment, m_params.lambda, &potential);
+
+	m_align_num = _getAlignNum(m_alignment);
+	m_rmsd = m_chain_a->getRMSD(*m_chain_b, m_translation, m_rotation, m_alignment);
+	Logger::debug("\tImproved: %d, RMSD: %f", m_align_num, m_rmsd);
+
+	return m_rmsd;
+}
+
+void PairAlign::setSolution(const double translation[3], const double rotation[3][3], const vector<int> &alignment)
+{
+	int i, j;
+	for (i=0; i<3; i++) {
+		m_translation[i] = translation[i];
+		for (j=0; j<3; j++) {
+			m_rotation[i][j] = rotation[i][j];
+		}
+	}
+	for (i=0; i<m_length_a; i++) {
+		m_alignment[i] = alignment[i];
+	}
+}
+
+bool PairAlign::solveLeastSquare(double translation[3], double rotation[3][3], vector<int> &alignment, double *rmsd)
+{
+	Superposition superposition;
+	bool success;
+	int k;
+
+	for (k=0; k<m_length_a; k++) {
+		if (alignment[k] >= 0) {
+			_addPair(superposition, k, alignment[k]);
+		}
+	}
+
+	// no aligned pair keeps the identity transformation
+	success = superposition.solve(translation, rotation);
+	if (rmsd != NULL) {
+		*rmsd = superposition.rmsd(translation, rotation);
+	}
+	return success;
+}
+
+
+// for using FibHeap
+
+class HeapNode: public FibHeapNode
+{
+	double m_label;
+	int m_index;
+
+public:
+	HeapNode() : FibHeapNode() { m_label = 0; };
+
+	virtual void operator =(FibHeapNode& RHS);
+	virtual int  operator ==(FibHeapNode& RHS);
+	virtual int  operator <(FibHeapNode& RHS);
+
+	virtual void operator =(double key);
+
+	double getKeyValue() { return m_label; }
+	void setKeyValue(double key) { m_label = key; }
+
+	int getIndexValue() { return m_index; }
+	void setIndexValue(int i) { m_index = i; }
+};
+
+void HeapNode::operator =(double label)
+{
+	HeapNode temp;
+	temp.m_label = m_label = label;
+	FHN_assign(temp);
+}
+
+void HeapNode::operator =(FibHeapNode& RHS)
+{
+	FHN_assign(RHS);
+	m_label = ((HeapNode&) RHS).m_label;
+}
+
+int  HeapNode::operator ==(FibHeapNode& RHS)
+{
+	if (FHN_compare(RHS)) return 0;
+	return m_label == ((HeapNode&) RHS).m_label ? 1 : 0;
+}
+
+int  HeapNode::operator <(FibHeapNode& RHS)
+{
+	int X;
+
+	if ((X=FHN_compare(RHS)) != 0) return X < 0 ? 1 : 0;
+	return m_label < ((HeapNode&) RHS).m_label ? 1 : 0;
+}
+
+
+// FibHeap with the interface of DaryHeap, kept as a reference priority queue
+
+class FibHeapQueue {
+	FibHeap m_heap;
+	HeapNode *m_nodes;
+	vector<bool> m_in_heap;
+
+public:
+	FibHeapQueue() { m_nodes = NULL; }
+	~FibHeapQueue() { delete[] m_nodes; }
+
+	double key(int i) { return m_nodes[i].getKeyValue(); }
+
+	void reset(int n);
+	void update(int i, double key);
+	int extractMin();
+};
+
+void FibHeapQueue::reset(int n)
+{
+	int i;
+	while (m_heap.extractMin() != NULL);
+	if (n != (int) m_in_heap.size()) {
+		delete[] m_nodes;
+		m_nodes = new HeapNode [n];
+	}
+	m_in_heap.assign(n, false);
+	for (i=0; i<n; i++) {
+		m_nodes[i].setIndexValue(i);
+		m_nodes[i].setKeyValue(HUGE_VAL);
+	}
+}
+
+void FibHeapQueue::update(int i, double key)
+{
+	HeapNode temp_label;
+	if (!m_in_heap[i]) {
+		m_nodes[i].setKeyValue(key);
+		m_heap.insert(&m_nodes[i]);
+		m_in_heap[i] = true;
+	}
+	else {
+		temp_label = m_nodes[i];
+		temp_label.setKeyValue(key);
+		m_heap.decreaseKey(&m_nodes[i], temp_label);
+	}
+}
+
+int FibHeapQueue::extractMin()
+{
+	HeapNode *min_label = (HeapNode *)m_heap.extractMin();
+	if (min_label == NULL) return -1;
+	return min_label->getIndexValue();
+}
+
+
+// Repair a matching of the previous round for the new weights. In the residual
+// graph of the matching, the source s is linked to the residues of chain b and
+// the residues of chain a are linked to the sink t, and the edge t->s closes
+// augmenting paths into cycles, so the matching is optimal if and only if there
+// is no negative cycle. The cycles are found by Bellman-Ford on the costs
+// reduced by the potentials of the previous round, which are nearly feasible
+// when the superposition moved little. Returns false if the matching is too far
+// from optimal, and then the matching should be solved from scratch.
+
+bool PairAlign::_repairMatch(const vector<int> &active_start, const vector<int> &active_index, const vector<double> &weight,
+							 vector<int> &alignment, int *match_edge, vector<double> *potential)
+{
+	AlignWorkspace &workspace = _getWorkspace();
+	vector<int> &match_b = workspace.match_b, &res_start = workspace.res_start;
+	vector<int> &res_to = workspace.res_to, &res_edge = workspace.res_edge;
+	vector<double> &res_cost = workspace.res_cost, &pi = workspace.pi, &dist = workspace.dist;
+	vector<int> &pred = workspace.pred, &pred_edge = workspace.pred_edge, &queue = workspace.queue;
+	vector<int> &visited = workspace.visited, &cycle = workspace.cycle, &cycle_tail = workspace.cycle_tail;
+	vector<bool> &queued = workspace.queued;
+	int node_num, node_s, node_t, match_num, cycle_num, max_cycle_num;
+	int relax_num, max_relax_num, head, tail, u, v, r, i, j, k;
+	double d;
+
+	node_num = m_length_b + m_length_a + 2;
+	node_s = node_num - 2;
+	node_t = node_num - 1;
+	max_cycle_num = 8 + min(m_length_a, m_length_b) / 16;
+	max_relax_num = 16 * (active_index.size() + node_num);
+
+	// keep the pairs of the previous matching which are still active
+	match_b.assign(m_length_b, -1);
+	match_num = 0;
+	for (j=0; j<m_length_a; j++) {
+		i = alignment[j];
+		match_edge[j] = -1;
+		alignment[j] = -1;
+		if (i < 0 || i >= m_length_b || match_b[i] >= 0) continue;
+		k = lower_bound(active_index.begin()+active_start[i], active_index.begin()+active_start[i+1], j) - active_index.begin();
+		if (k < active_start[i+1] && active_index[k] == j && weight[k] < 0) {
+			alignment[j] = i;
+			match_edge[j] = k;
+			match_b[i] = j;
+			match_num++;
+		}
+	}
+
+	if (potential != NULL && (int) potential->size() == node_num) {
+		pi.assign(potential->begin(), potential->end());
+	}
+	else {
+		pi.assign(node_num, 0);
+	}
+
+	dist.resize(node_num);
+	pred.resize(node_num);
+	pred_edge.resize(node_num);
+	queue.resize(node_num+1);
+	queued.resize(node_num);
+	res_start.resize(node_num+1);
+
+	cycle_num = 0;
+	while (true) {
+		// residual graph, nodes 0..m_length_b-1 are residues of chain b and
+		// m_length_b..m_length_b+m_length_a-1 are residues of chain a,
+		// res_edge is the active pair of an edge between them, otherwise -1
+		res_to.clear();
+		res_edge.clear();
+		res_cost.clear();
+		for (i=0; i<m_length_b; i++) {
+			res_start[i] = res_to.size();
+			if (match_b[i] >= 0) {
+				res_to.push_back(node_s);
+				res_edge.push_back(-1);
+				res_cost.push_back(0);
+			}
+			for (k=active_start[i]; k<active_start[i+1]; k++) {
+				if (match_b[i] != active_index[k]) {
+					res_to.push_back(m_length_b+active_index[k]);
+					res_edge.push_back(k);
+					res_cost.push_back(weight[k]);
+				}
+			}
+		}
+		for (j=0; j<m_length_a; j++) {
+			res_start[m_length_b+j] = res_to.size();
+			if (alignment[j] >= 0) {
+				res_to.push_back(alignment[j]);
+				res_edge.push_back(match_edge[j]);
+				res_cost.push_back(-weight[match_edge[j]]);
+			}
+			else {
+				res_to.push_back(node_t);
+				res_edge.push_back(-1);
+				res_cost.push_back(0);
+			}
+		}
+		res_start[node_s] = res_to.size();
+		for (i=0; i<m_length_b; i++) {
+			if (match_b[i] < 0) {
+				res_to.push_back(i);
+				res_edge.push_back(-1);
+				res_cost.push_back(0);
+			}
+		}
+		if (match_num > 0) {
+			res_to.push_back(node_t);
+			res_edge.push_back(-1);
+			res_cost.push_back(0);
+		}
+		res_start[node_t] = res_to.size();
+		for (j=0; j<m_length_a; j++) {
+			if (alignment[j] >= 0) {
+				res_to.push_back(m_length_b+j);
+				res_edge.push_back(-1);
+				res_cost.push_back(0);
+			}
+		}
+		res_to.push_back(node_s);
+		res_edge.push_back(-1);
+		res_cost.push_back(0);
+		res_start[node_num] = res_to.size();
+		for (u=0; u<node_num; u++) {
+			for (r=res_start[u]; r<res_start[u+1]; r++) {
+				res_cost[r] += pi[u] - pi[res_to[r]];
+			}
+		}
+
+		// Bellman-Ford with a queue from a virtual source linked to all nodes,
+		// the predecessor graph is checked for cycles after every node_num
+		// relaxations, and a cycle found there is negative
+		for (u=0; u<node_num; u++) {
+			dist[u] = 0;
+			pred[u] = -1;
+			pred_edge[u] = -1;
+			queue[u] = u;
+			queued[u] = true;
+		}
+		head = 0;
+		tail = node_num;
+		relax_num = 0;
+		cycle.clear();
+		cycle_tail.clear();
+		while (cycle.empty() && head != tail) {
+			u = queue[head];
+			head = (head + 1) % (node_num + 1);
+			queued[u] = false;
+			for (r=res_start[u]; r<res_start[u+1]; r++) {
+				d = dist[u] + res_cost[r];
+				v = res_to[r];
+				if (d < dist[v] - 1e-9) {
+					dist[v] = d;
+					pred[v] = u;
+					pred_edge[v] = r;
+					relax_num++;
+					if (!queued[v]) {
+						queue[tail] = v;
+						tail = (tail + 1) % (node_num + 1);
+						queued[v] = true;
+					}
+				}
+			}
+			if (relax_num >= node_num) {
+				max_relax_num -= relax_num;
+				if (max_relax_num < 0) return false;
+				relax_num = 0;
+				// the cycles of the predecessor graph are disjoint
+				visited.assign(node_num, -1);
+				for (k=0; k<node_num; k++) {
+					v = k;
+					while (v >= 0 && visited[v] < 0) {
+						visited[v] = k;
+						v = pred[v];
+					}
+					if (v >= 0 && visited[v] == k) {
+						u = v;
+						do {
+							cycle.push_back(pred_edge[u]);
+							cycle_tail.push_back(pred[u]);
+							u = pred[u];
+						} while (u != v);
+					}
+				}
+			}
+		}
+		if (cycle.empty()) break;
+		cycle_num++;
+		if (cycle_num > max_cycle_num) return false;
+
+		// cancel the cycles, edges a->b leave the matching and edges b->a enter
+		for (k=0; k<(int) cycle.size(); k++) {
+			r = cycle[k];
+			if (res_edge[r] >= 0 && res_to[r] < m_length_b) {
+				j = active_index[res_edge[r]];
+				match_b[alignment[j]] = -1;
+				alignment[j] = -1;
+				match_edge[j] = -1;
+				match_num--;
+			}
+		}
+		for (k=0; k<(int) cycle.size(); k++) {
+			r = cycle[k];
+			if (res_edge[r] >= 0 && res_to[r] >= m_length_b) {
+				i = cycle_tail[k];
+				j = res_to[r] - m_length_b;
+				alignment[j] = i;
+				match_edge[j] = res_edge[r];
+				match_b[i] = j;
+				match_num++;
+			}
+		}
+	}
+
+	// the shortest distances make the reduced costs nonnegative
+	if (potential != NULL) {
+		potential->resize(node_num);
+		for (u=0; u<node_num; u++) {
+			(*potential)[u] = pi[u] + dist[u];
+		}
+	}
+	return true;
+}
+
+double PairAlign::solveMaxMatch(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda, vector<double> *potential)
+{
+	AlignWorkspace &workspace = _getWorkspace();
+	if (m_params.priority_queue == "fib") {
+		if (workspace.fib_heap.get() == NULL) workspace.fib_heap.reset(new FibHeapQueue);
+		return _solveMaxMatch(translation, rotation, alignment, lambda, potential, *workspace.fib_heap);
+	}
+	else {
+		return _solveMaxMatch(translation, rotation, alignment, lambda, potential, workspace.heap);
+	}
+}
+
+template <class Heap>
+double PairAlign::_solveMaxMatch(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda,
+								 vector<double> *potential, Heap &heap)
+{
+	AlignWorkspace &workspace = _getWorkspace();
+	vector<int> &active_start = workspace.active_start, &active_index = workspace.active_index;
+	vector<double> &weight = workspace.weight;
+	double score, reduced_cost, label_t, current_value;
+	double *sink_weight;
+	bool *match_free, *label_free;
+	int *match_edge, *backtrack, *backtrack_edge, backtrack_t;
+	double d;
+	int i, j, k;
+
+	// weight[j] is the weight of the j-th active pair, the pairs of residue i
+	// of chain b are active_start[i] .. active_start[i+1]-1
+	_getActivePairs(translation, rotation, lambda, active_start, active_index, weight);
+
+	lambda = lambda * lambda;
+	for (i=0; i<m_length_b; i++) {
+		for (j=active_start[i]; j<active_start[i+1]; j++) {
+			weight[j] -= lambda;
+			weight[j] *= _getWeight(active_index[j], i);
+		}
+	}
+
+	workspace.match_edge.resize(m_length_a);
+	match_edge = workspace.match_edge.data();
+
+	// start from the previous matching if it can be repaired cheaply
+	if (m_params.warm_start && _repairMatch(active_start, active_index, weight, alignment, match_edge, potential)) {
+		score = 0;
+		for (j=0; j<m_length_a; j++) {
+			if (match_edge[j] >= 0) {
+				score += weight[match_edge[j]];
+			}
+		}
+		return score;
+	}
+	if (potential != NULL) {
+		potential->clear();
+	}
+
+	workspace.sink_weight.resize(m_length_a);
+	workspace.match_free.resize(m_length_b+m_length_a);
+	workspace.label_free.resize(m_length_b+m_length_a);
+	workspace.backtrack.resize(m_length_b+m_length_a);
+	workspace.backtrack_edge.resize(m_length_a);
+	sink_weight = workspace.sink_weight.data();
+	match_free = workspace.match_free.data();
+	label_free = workspace.label_free.data();
+	backtrack = workspace.backtrack.data();
+	backtrack_edge = workspace.backtrack_edge.data();
+	
+	for (i=0; i<m_length_b+m_length_a; i++) {
+		match_free[i] = true;
+	}
+	for (j=0; j<m_length_a; j++) {
+		alignment[j] = -1;
+		match_edge[j] = -1;
+		sink_weight[j] = 0;
+	}
+
+	reduced_cost = 0;
+	for (j=0; j<(int) weight.size(); j++) {
+		if (weight[j] < reduced_cost) {
+			reduced_cost = weight[j];
+		}
+	}
+	for (j=0; j<(int) weight.size(); j++) {
+		weight[j] -= reduced_cost;
+	}
+	score = 0;
+
+	while (true) {
+		// Dijkstra's algorithm, only the free nodes of chain b are queued
+		// initially, the others enter the heap when they are first labeled
+		heap.reset(m_length_b+m_length_a);
+		for (i=0; i<m_length_b+m_length_a; i++) {
+			if (i < m_length_b && match_free[i]) {
+				heap.update(i, 0);
+			}
+			label_free[i] = true;
+			backtrack[i] = -1;
+		}
+		label_t = HUGE_VAL;
+		backtrack_t = -1;
+		while ((i = heap.extractMin()) >= 0) {
+			current_value = heap.key(i);
+			label_free[i] = false;
+			if (i < m_length_b) {
+				for (j=active_start[i]; j<active_start[i+1]; j++) {
+					k = active_index[j];
+					if (label_free[m_length_b+k] && alignment[k] != i) {
+						d = current_value + weight[j];
+						if (d < heap.key(m_length_b+k)) {
+							heap.update(m_length_b+k, d);
+							backtrack[m_length_b+k] = i;
+							backtrack_edge[k] = j;
+						}
+					}
+				}
+			}
+			else {
+				k = alignment[i-m_length_b];
+				if (k >= 0 && label_free[k]) {
+					d = current_value - weight[match_edge[i-m_length_b]];
+					if (d < heap.key(k)) {
+						heap.update(k, d);
+						backtrack[k] = i;
+					}
+				}
+				if (match_free[i]) {
+					d = current_value + sink_weight[i-m_length_b];
+					if (d < label_t) {
+						label_t = d;
+						backtrack_t = i;
+					}
+				}
+			}
+		}
+		reduced_cost += label_t;
+		if (reduced_cost >= 0) break;
+		score += reduced_cost;
+
+		// Modify the weights
+		for (i=0; i<m_length_b; i++) {
+			for (j=active_start[i]; j<active_start[i+1]; j++) {
+				weight[j] += heap.key(i) - heap.key(m_length_b+active_index[j]);
+			}
+		}
+		for (j=0; j<m_length_a; j++) {
+			sink_weight[j] += heap.key(m_length_b+j) - label_t;
+		}
+
+		// Reverse path
+		k = backtrack_t;
+		while (k >= 0 && backtrack[k] >= 0) {
+			alignment[k-m_length_b] = backtrack[k];
+			match_edge[k-m_length_b] = backtrack_edge[k-m_length_b];
+			match_free[k] = false;
+			k = backtrack[k];
+			match_free[k] = false;
+			k = backtrack[k];
+		}
+	}
+
+	return score;
+}
+
+double PairAlign::solveMaxAlign(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda)
+{
+	if (m_params.single_precision) {
+		return _solveMaxAlign<float>(translation, rotation, alignment, lambda);
+	}
+	else {
+		return _solveMaxAlign<double>(translation, rotation, alignment, lambda);
+	}
+}
+
+// With a band width, the dynamic programming is restricted to a band of
+// diagonals j - i around the median diagonal of the active pairs, and the band
+// is doubled while the path found touches its inner edges. This is a heuristic,
+// a better path lying wholly outside the band is never seen, so the full table
+// is the default. Outside the band only one row of scores is kept, which holds
+// for every column the score of the last row where the column was in the band,
+// the exact score of the cells below the band as no pair there may be aligned.
+// Each cell in the band keeps a direction code of one byte, beyond align_memory
+// megabytes the linear memory method is used instead.
+//
+// Within a row the scores from the diagonal and upper cells are taken first,
+// which is free of branches and dependencies and may be vectorized, and then the
+// cells to the left are taken in one cheap sequential scan.
+
+template <class Real>
+double PairAlign::_solveMaxAlign(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda)
+{
+	enum { ALIGN_DIAG = 0, ALIGN_UP = 1, ALIGN_LEFT = 2, ALIGN_MATCH = 4 };
+
+	AlignWorkspace &workspace = _getWorkspace();
+	vector<int> &active_start = workspace.active_start, &active_index = workspace.active_index;
+	vector<int> &diagonals = workspace.diagonals, &band_start = workspace.band_start;
+	vector<double> &distance = workspace.weight;
+	Vector<unsigned char> &codes = workspace.codes;
+	AlignRows<Real> &rows = workspace.rows(Real());
+	Vector<Real> &weight = rows.weight, &score = rows.score, &upper = rows.upper;
+	unsigned char *code;
+	Real dd, da, left;
+	double memory;
+	int center, width, band_low, band_high, low, high;
+	int i, j, k;
+	bool full, touched;
+
+	_getActivePairs(translation, rotation, lambda, active_start, active_index, distance);
+	weight.resize(m_length_a);
+	score.resize(m_length_a);
+	upper.resize(m_length_a);
+
+	lambda = lambda * lambda;
+	for (k=0; k<(int) distance.size(); k++) {
+		distance[k] -= lambda;
+	}
+	for (j=0; j<m_length_a; j++) {
+		weight[j] = HUGE_VAL;
+		alignment[j] = -1;
+	}
+	if (distance.empty()) return 0;
+
+	diagonals.clear();
+	for (i=0; i<m_length_b; i++) {
+		for (k=active_start[i]; k<active_start[i+1]; k++) {
+			diagonals.push_back(active_index[k] - i);
+		}
+	}
+	nth_element(diagonals.begin(), diagonals.begin() + diagonals.size() / 2, diagonals.end());
+	center = diagonals[diagonals.size() / 2];
+
+	band_start.resize(m_length_b + 1);
+	width = m_params.band_width;
+	do {
+		if (width <= 0 || (center - width <= 1 - m_length_b && center + width >= m_length_a - 1)) {
+			band_low = 1 - m_length_b;
+			band_high = m_length_a - 1;
+			full = true;
+		}
+		else {
+			band_low = center - width;
+			band_high = center + width;
+			full = false;
+		}
+		band_start[0] = 0;
+		for (i=0; i<m_length_b; i++) {
+			low = max(i + band_low, 0);
+			high = min(i + band_high, m_length_a - 1);
+			band_start[i+1] = band_start[i] + max(high - low + 1, 0);
+		}
+		memory = band_start[m_length_b];
+		if (memory > m_params.align_memory * 1048576.0) {
+			return _solveMaxAlignLinear<Real>(active_start, active_index, distance, alignment, weight);
+		}
+		codes.resize(band_start[m_length_b]);
+
+		for (j=0; j<m_length_a; j++) {
+			score[j] = 0;
+		}
+		for (i=0; i<m_length_b; i++) {
+			low = max(i + band_low, 0);
+			high = min(i + band_high, m_length_a - 1);
+			if (low > high) continue;
+			code = codes.data() + band_start[i] - low;
+			for (k=active_start[i]; k<active_start[i+1]; k++) {
+				weight[active_index[k]] = distance[k];
+			}
+			if (i == 0) {
+				left = (low > 0) ? score[low-1] : (Real) 0;
+				for (j=low; j<=high; j++) {
+					if (weight[j] <= left) {
+						left = weight[j];
+						code[j] = ALIGN_DIAG | ALIGN_MATCH;
+					}
+					else {
+						code[j] = ALIGN_LEFT;
+					}
+					score[j] = left;
+				}
+			}
+			else {
+				j = low;
+				if (low == 0) {
+					if (weight[0] <= score[0]) {
+						upper[0] = weight[0];
+						code[0] = ALIGN_DIAG | ALIGN_MATCH;
+					}
+					else {
+						upper[0] = score[0];
+						code[0] = ALIGN_UP;
+					}
+					j = 1;
+				}
+				for (; j<=high; j++) {
+					dd = score[j-1] + min(weight[j], (Real) 0);
+					da = score[j];
+					upper[j] = (dd <= da) ? dd : da;
+					code[j] = (dd <= da) ? (weight[j] <= 0 ? ALIGN_DIAG | ALIGN_MATCH : ALIGN_DIAG) : ALIGN_UP;
+				}
+				j = low;
+				if (low == 0) {
+					score[0] = upper[0];
+					j = 1;
+				}
+				left = score[j-1];
+				for (; j<=high; j++) {
+					if (upper[j] <= left) {
+						left = upper[j];
+					}
+					else {
+						code[j] = ALIGN_LEFT;
+					}
+					score[j] = left;
+				}
+			}
+			for (k=active_start[i]; k<active_start[i+1]; k++) {
+				weight[active_index[k]] = HUGE_VAL;
+			}
+		}
+
+		// the cells outside the band take the scores of the nearest cells of
+		// the band above or to the left of them
+		for (j=0; j<m_length_a; j++) {
+			alignment[j] = -1;
+		}
+		touched = false;
+		i = m_length_b - 1;
+		j = m_length_a - 1;
+		if (j - i < band_low) i = j - band_low;
+		if (j - i > band_high) j = i + band_high;
+		while (i >= 0 && j >= 0) {
+			low = max(i + band_low, 0);
+			high = min(i + band_high, m_length_a - 1);
+			if (!full && ((j == low && low > 0) || (j == high && high < m_length_a - 1))) touched = true;
+			k = codes[band_start[i] + j - low];
+			if (k & ALIGN_MATCH) alignment[j] = i;
+			if ((k & 3) == ALIGN_DIAG) {
+				i--;
+				j--;
+			}
+			else if ((k & 3) == ALIGN_UP) {
+				i--;
+			}
+			else {
+				j--;
+			}
+		}
+		width *= 2;
+	} while (touched);
+
+	j = min(m_length_a - 1, m_length_b - 1 + band_high);
+	return (j >= 0) ? score[j] : 0;
+}
+
+// the same sequential alignment by the divide and conquer method of Hirschberg,
+// which keeps only a few rows of scores, pair_weight holds the weights of the
+// active pairs and weight holds HUGE_VAL
+
+template <class Real>
+double PairAlign::_solveMaxAlignLinear(const vector<int> &active_start, const vector<int> &active_index, const vector<double> &pair_weight,
+									   vector<int> &alignment, Vector<Real> &weight)
+{
+	AlignRows<Real> &rows = _getWorkspace().rows(Real());
+	Vector<Real> &forward = rows.forward, &backward = rows.backward;
+	int i;
+
+	forward.resize(m_length_a + 1);
+	backward.resize(m_length_a + 1);
+	for (i=0; i<m_length_a; i++) {
+		alignment[i] = -1;
+	}
+	return _alignLinear(0, m_length_b, 0, m_length_a, active_start, active_index, pair_weight,
+		alignment, weight, forward, backward);
+}
+
+// align residues begin_b .. end_b-1 of chain b to residues begin_a .. end_a-1
+// of chain a, and return the score. The rows of chain b are split in half, the
+// best scores of the upper half ending before each residue of chain a and of the
+// lower half starting at it are computed by a forward and a backward pass, and
+// both halves are aligned recursively on the two sides of the best split.
+// weight holds HUGE_VAL except while a row of active pairs is spread in it.
+
+template <class Real>
+Real PairAlign::_alignLinear(int begin_b, int end_b, int begin_a, int end_a,
+							 const vector<int> &active_start, const vector<int> &active_index, const vector<double> &pair_weight,
+							 vector<int> &alignment, Vector<Real> &weight, Vector<Real> &forward, Vector<Real> &backward)
+{
+	Real *f, *g, d, diag, score;
+	int mid, split, n, i, j, k;
+
+	if (begin_b >= end_b || begin_a >= end_a) return 0;
+
+	if (end_b - begin_b == 1) {
+		for (k=active_start[begin_b]; k<active_start[begin_b+1]; k++) {
+			weight[active_index[k]] = pair_weight[k];
+		}
+		score = 0;
+		split = -1;
+		for (j=begin_a; j<end_a; j++) {
+			if (weight[j] <= score) {
+				score = weight[j];
+				split = j;
+			}
+		}
+		if (split >= 0) alignment[split] = begin_b;
+		for (k=active_start[begin_b]; k<active_start[begin_b+1]; k++) {
+			weight[active_index[k]] = HUGE_VAL;
+		}
+		return score;
+	}
+
+	// f[t] is the best score of rows begin_b .. mid-1 with residues before begin_a + t,
+	// g[t] is the best score of rows mid .. end_b-1 with residues from begin_a + t
+	mid = (begin_b + end_b) / 2;
+	n = end_a - begin_a;
+	f = forward.data();
+	g = backward.data();
+	for (j=0; j<=n; j++) {
+		f[j] = 0;
+		g[j] = 0;
+	}
+	for (i=begin_b; i<mid; i++) {
+		for (k=active_start[i]; k<active_start[i+1]; k++) {
+			weight[active_index[k]] = pair_weight[k];
+		}
+		diag = 0;
+		for (j=1; j<=n; j++) {
+			d = diag + min(weight[begin_a+j-1], (Real) 0);
+			d = min(d, min(f[j], f[j-1]));
+			diag = f[j];
+			f[j] = d;
+		}
+		for (k=active_start[i]; k<active_start[i+1]; k++) {
+			weight[active_index[k]] = HUGE_VAL;
+		}
+	}
+	for (i=end_b-1; i>=mid; i--) {
+		for (k=active_start[i]; k<active_start[i+1]; k++) {
+			weight[active_index[k]] = pair_weight[k];
+		}
+		diag = 0;
+		for (j=n-1; j>=0; j--) {
+			d = diag + min(weight[begin_a+j], (Real) 0);
+			d = min(d, min(g[j], g[j+1]));
+			diag = g[j];
+			g[j] = d;
+		}
+		for (k=active_start[i]; k<active_start[i+1]; k++) {
+			weight[active_index[k]] = HUGE_VAL;
+		}
+	}
+
+	// on ties the upper half takes as many residues as possible, as the
+	// backtracking of the full dynamic programming does
+	split = 0;
+	for (j=1; j<=n; j++) {
+		if (f[j] + g[j] <= f[split] + g[split]) split = j;
+	}
+	split += begin_a;
+
+	score = _alignLinear(begin_b, mid, begin_a, split, active_start, active_index, pair_weight,
+		alignment, weight, forward, backward);
+	score += _alignLinear(mid, end_b, split, end_a, active_start, active_index, pair_weight,
+		alignment, weight, forward, backward);
+	return score;
+}
+
+void PairAlign::writePDBFile(const string &filename) const
+{
+	FILE *fp;
+	char buffer[80];
+
+	if ((fp = fopen(filename.c_str(), "w")) == NULL) {
+		Logger::error("Can not open the file: %s\n", filename.c_str());
+		exit(1);
+	}
+
+	fprintf(fp, "HEADER    %-40s%30c\n", "PAIRWISE PROTEIN STRUCTURE ALIGNMENT", ' ');
+
+	strcpy(buffer, "ALIGNMENT RESULT OF ");
+	strcat(buffer, m_chain_a->raw_name());
+	strcat(buffer, " AND ");
+	strcat(buffer, m_chain_b->raw_name());
+	fprintf(fp, "TITLE     %-60s%10c\n", buffer, ' ');
+
+	m_chain_a->writePDBModel(fp, 1, true, m_translation, m_rotation);
+	m_chain_b->writePDBModel(fp, 2, true);
+
+	fprintf(fp, "END   %74c\n", ' ');
+
+	fclose(fp);
+}
+
+void PairAlign::writeSolutionFile(const string &filename) const
+{
+	FILE *fp;
+	int i, j;
+
+	if ((fp = fopen(filename.c_str(), "w")) == NULL) {
+		Logger::error("Can not open the file: %s\n", filename.c_str());
+		exit(1);
+	}
+
+	fprintf(fp, "[Abstact]\n");
+	fprintf(fp, "Alignment result of %s AND %s\n\n", m_chain_a->raw_name(), m_chain_b->raw_name());
+
+	fprintf(fp, "[Result]\n");
+	fprintf(fp, " %f %d\n\n", m_rmsd, m_align_num);
+
+	fprintf(fp, "[Alignment]\n");
+	for (i=0; i<m_length_a; i++) {
+		fprintf(fp, " %3d", m_alignment[i]);
+		if (i % 20 == 19) {
+			fprintf(fp, "\n");
+		}
+	}
+	fprintf(fp, "\n\n");
+	
+	fprintf(fp, "[Translation]\n");
+	for (i=0; i<3; i++) {
+		fprintf(fp, " %lf", m_translation[i]);
+	}
+	fprintf(fp, "\n\n");
+
+	fprintf(fp, "[Rotation]\n");
+	for (i=0; i<3; i++) {
+		for (j=0; j<3; j++) {
+			fprintf(fp, " %lf", m_rotation[i][j]);
+		}
+		fprintf(fp, "\n");
+	}
+	fprintf(fp, "\n");
+
+	fclose(fp);
+}
+
+// resize the weight matrix to m_length_b x m_length_a and fill it with a value
+
+template <class Real>
+void PairAlign::_fillWeights(DenseMatrix<Real> &weights, Real value)
+{
+	weights.resize(m_length_b, m_length_a);
+	weights.fill(value);
+}
+
+// all inner distances of a chain
+
+void PairAlign::_getInnerDistance(const ProteinChain &chain, DenseMatrix<double> &distance)
+{
+	int n, i, j, k;
+	double d;
+
+	n = chain.length();
+	distance.resize(n, n);
+	for (i=0; i<n; i++) {
+		distance[i][i] = 0;
+		for (j=0; j<i; j++) {
+			d = 0;
+			for (k=0; k<3; k++) {
+				d += square(chain.coords(k)[i] - chain.coords(k)[j]);
+			}
+			distance[i][j] = distance[j][i] = sqrt(d);
+		}
+	}
+}
+
+// inner distances of a chain near the diagonal, band[l][i] is the distance
+// between residues i and i+l for 0 < l < width
+
+void PairAlign::_getBandDistance(const ProteinChain &chain, int width, vector<vector<double> > &band)
+{
+	const double *x = chain.coords(0), *y = chain.coords(1), *z = chain.coords(2);
+	double *row, dx, dy, dz;
+	int n, i, l;
+
+	n = chain.length();
+	band.resize(width);
+	for (l=1; l<width; l++) {
+		band[l].resize(max(n - l, 0));
+		row = band[l].empty() ? NULL : &band[l][0];
+		for (i=0; i+l<n; i++) {
+			dx = x[i+l] - x[i];
+			dy = y[i+l] - y[i];
+			dz = z[i+l] - z[i];
+			row[i] = sqrt(dx * dx + dy * dy + dz * dz);
+		}
+	}
+}
+
+// full sum of |A(i+k, i+l) - B(j+k, j+l)| for k, l < f, by symmetry twice the
+// sum over k < l
+
+double PairAlign::_getFragmentDistance(const vector<vector<double> > &band_a, const vector<vector<double> > &band_b, int i, int j, int f)
+{
+	double s;
+	int k, l;
+	s = 0;
+	for (k=0; k<f; k++) {
+		for (l=k+1; l<f; l++) {
+			s += fabs(band_a[l-k][i+k] - band_b[l-k][j+k]);
+		}
+	}
+	return 2 * s;
+}
+
+// sum of the differences of the three distances of the hash keys, a cheap
+// ranking of the pairs before _getFragmentDistance
+
+double PairAlign::_getKeyDistance(const vector<vector<double> > &band_a, const vector<vector<double> > &band_b, int i, int j, int f)
+{
+	return fabs(band_a[f-1][i] - band_b[f-1][j]) + fabs(band_a[f/2][i] - band_b[f/2][j])
+		+ fabs(band_a[f-1-f/2][i+f/2] - band_b[f-1-f/2][j+f/2]);
+}
+
+// hash key of the fragment starting at i by the distances between its first,
+// middle and last residues in bins of 2A, shift 0..26 moves each bin by -1, 0
+// or +1 to reach the neighboring keys and 13 keeps all of them, -1 if a bin
+// falls out of range
+
+int PairAlign::_getFragmentKey(const vector<vector<double> > &band, int i, int f, int shift)
+{
+	double d[3];
+	int key, bin, k;
+	d[0] = band[f-1][i];
+	d[1] = band[f/2][i];
+	d[2] = band[f-1-f/2][i+f/2];
+	key = 0;
+	for (k=0; k<3; k++) {
+		bin = (int) (d[k] / 2.0) + shift % 3 - 1;
+		shift /= 3;
+		if (bin < 0 || bin >= 64) return -1;
+		key = key * 64 + bin;
+	}
+	return key;
+}
+
+// sum[j] += factor * |a - b[j]| for j < n, the innermost loop of the similarity
+
+void PairAlign::_addBandDistance(double a, const double *b, double factor, double *sum, int n)
+{
+	int j;
+	for (j=0; j<n; j++) {
+		sum[j] += factor * fabs(a - b[j]);
+	}
+}
+
+// add a pair of residues to a superposition, with its weight or evenly
+
+void PairAlign::_addPair(Superposition &superposition, int a, int b, bool weighted)
+{
+	double x[3], y[3];
+	int i;
+	for (i=0; i<3; i++) {
+		x[i] = m_chain_a->coords(i)[a];
+		y[i] = m_chain_b->coords(i)[b];
+	}
+	superposition.add(x, y, weighted ? _getWeight(a, b) : 1.0);
+}
+
+// whether the time limit of the alignment is reached, the solvers check it
+// between iterations and stop with the best solution found so far
+
+bool PairAlign::_timeout()
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	if (!m_truncated && m_params.time_limit > 0 && boost::posix_time::microsec_clock::universal_time() > m_deadline) {
+		m_truncated = true;
+	}
+	return m_truncated;
+}
+
+// the workspace of the calling thread, it lives until the thread exits
+
+boost::thread_specific_ptr<AlignWorkspace> PairAlign::m_workspace;
+
+// the pool shared by all alignments, so its threads and their workspaces are
+// kept; it is defined after the workspaces, so its threads are joined before
+// those are destroyed
+
+ThreadPool PairAlign::m_pool;
+
+AlignWorkspace &PairAlign::_getWorkspace()
+{
+	if (m_workspace.get() == NULL) {
+		m_workspace.reset(new AlignWorkspace);
+	}
+	return *m_workspace;
+}
+
+// Active pairs when lambda spans the whole chain, as in the first levels of
+// annealing. Square distances are computed as |a|^2 + |b|^2 - 2 a.b over the
+// coordinates centered at chain b, which keeps the norms small, for tiles of
+// four residues of chain b against all of chain a held in x, y and z. Each
+// residue of a is loaded once per tile and the four rows stay in registers,
+// and the lambda threshold is applied when the tile is written out.
+
+void PairAlign::_getDensePairs(double lambda, vector<int> &active_start, vector<int> &active_index, vector<double> &distance)
+{
+	enum { TILE = 4 };
+	AlignWorkspace &workspace = _getWorkspace();
+	Vector<double> &x = workspace.x, &y = workspace.y, &z = workspace.z;
+	Vector<double> &norm_a = workspace.norm_a, &tile = workspace.tile;
+	const double *bx = m_chain_b->coords(0), *by = m_chain_b->coords(1), *bz = m_chain_b->coords(2);
+	double center[3], px[TILE], py[TILE], pz[TILE], pn[TILE], lambda2, d;
+	double *row[TILE];
+	int i, j, r, tile_num;
+
+	center[0] = center[1] = center[2] = 0;
+	for (i=0; i<m_length_b; i++) {
+		center[0] += bx[i];
+		center[1] += by[i];
+		center[2] += bz[i];
+	}
+	for (r=0; r<3; r++) {
+		center[r] /= max(m_length_b, 1);
+	}
+	norm_a.resize(m_length_a);
+	for (j=0; j<m_length_a; j++) {
+		x[j] -= center[0];
+		y[j] -= center[1];
+		z[j] -= center[2];
+		norm_a[j] = x[j] * x[j] + y[j] * y[j] + z[j] * z[j];
+	}
+	tile.resize(TILE * m_length_a);
+
+	lambda2 = lambda * lambda;
+	active_start.resize(m_length_b+1);
+	active_index.clear();
+	distance.clear();
+	active_start[0] = 0;
+	for (i=0; i<m_length_b; i+=TILE) {
+		tile_num = min((int) TILE, m_length_b - i);
+		for (r=0; r<TILE; r++) {
+			// rows beyond chain b repeat its last residue and are dropped
+			px[r] = bx[i+min(r, tile_num-1)] - center[0];
+			py[r] = by[i+min(r, tile_num-1)] - center[1];
+			pz[r] = bz[i+min(r, tile_num-1)] - center[2];
+			pn[r] = px[r] * px[r] + py[r] * py[r] + pz[r] * pz[r];
+			row[r] = tile.data() + r * m_length_a;
+		}
+		for (j=0; j<m_length_a; j++) {
+			row[0][j] = pn[0] + norm_a[j] - 2 * (px[0] * x[j] + py[0] * y[j] + pz[0] * z[j]);
+			row[1][j] = pn[1] + norm_a[j] - 2 * (px[1] * x[j] + py[1] * y[j] + pz[1] * z[j]);
+			row[2][j] = pn[2] + norm_a[j] - 2 * (px[2] * x[j] + py[2] * y[j] + pz[2] * z[j]);
+			row[3][j] = pn[3] + norm_a[j] - 2 * (px[3] * x[j] + py[3] * y[j] + pz[3] * z[j]);
+		}
+		for (r=0; r<tile_num; r++) {
+			for (j=0; j<m_length_a; j++) {
+				d = row[r][j];
+				if (d <= lambda2) {
+					active_index.push_back(j);
+					distance.push_back(max(d, 0.0));
+				}
+			}
+			active_start[i+r+1] = active_index.size();
+		}
+	}
+}
+
+void PairAlign::_getActivePairs(const double translation[3], const double rotation[3][3], double lambda,
+								vector<int> &active_start, vector<int> &active_index, vector<double> &distance)
+{
+	AlignWorkspace &workspace = _getWorkspace();
+	SpatialGrid &grid = workspace.grid;
+	Vector<double> &x = workspace.x, &y = workspace.y, &z = workspace.z;
+	vector<int> &neighbors = workspace.neighbors;
+	vector<double> &distances = workspace.distances;
+	vector<pair<int, double> > &pairs = workspace.pairs;
+	double point[3];
+	int i, j, k;
+
+	x.resize(m_length_a);
+	y.resize(m_length_a);
+	z.resize(m_length_a);
+	m_chain_a->transform(translation, rotation, x.data(), y.data(), z.data());
+	grid.build(x.data(), y.data(), z.data(), m_length_a, lambda);
+	if (grid.dense()) {
+		_getDensePairs(lambda, active_start, active_index, distance);
+		return;
+	}
+
+	active_start.resize(m_length_b+1);
+	active_index.clear();
+	distance.clear();
+	active_start[0] = 0;
+	for (i=0; i<m_length_b; i++) {
+		neighbors.clear();
+		distances.clear();
+		for (k=0; k<3; k++) {
+			point[k] = m_chain_b->coords(k)[i];
+		}
+		grid.query(point, lambda, neighbors, distances);
+		pairs.resize(neighbors.size());
+		for (j=0; j<(int) neighbors.size(); j++) {
+			pairs[j] = make_pair(neighbors[j], distances[j]);
+		}
+		sort(pairs.begin(), pairs.end());
+		for (j=0; j<(int) pairs.size(); j++) {
+			active_index.push_back(pairs[j].first);
+			distance.push_back(pairs[j].second);
+		}
+		active_start[i+1] = active_index.size();
+	}
+}
+
+void PairAlign::_alignStart(vector<AlignSolution> &solutions, const vector<int> &starts, int round_num, int k)
+{
+	int index = starts[k];
+	AlignSolution &solution = solutions[index];
+
+	solution.skipped = (index > 0 && _timeout());
+	if (solution.skipped || solution.finished) return;
+
+	if (!solution.started) {
+		solution.started = true;
+		solution.lambda = m_params.annealing ? m_params.annealing_initial : 0;
+		solution.round_score = HUGE_VAL;
+		solveLeastSquare(solution.translation, solution.rotation, solution.alignment, &solution.initial_rmsd);
+	}
+	if (_iterateStart(solution, round_num)) {
+		_finishStart(solution);
+	}
+	else {
+		// score of the current superposition under the final lambda, the
+		// alignment and the score of the last round are kept for the next
+		// round of annealing
+		vector<int> alignment(solution.alignment);
+		solution.race_score = m_params.annealing ?
+			solveMaxMatch(solution.translation, solution.rotation, alignment, m_params.lambda) : solution.round_score;
+	}
+}
+
+// run the rounds of least square and matching of a start, at most round_num of
+// them if round_num > 0, returns true when the start converges at the last
+// level of annealing
+
+bool PairAlign::_iterateStart(AlignSolution &solution, int round_num)
+{
+	double score_old, score_new;
+	int round;
+
+	for (round=0; round_num <= 0 || round < round_num; round++) {
+		if (_timeout()) return true;
+		score_old = solution.round_score;
+		solveLeastSquare(solution.translation, solution.rotation, solution.alignment);
+		score_new = solveMaxMatch(solution.translation, solution.rotation, solution.alignment,
+			m_params.lambda+solution.lambda, &solution.potential);
+		solution.round_score = score_new;
+		if (m_params.annealing) {
+			Logger::debug("\t%f, %f", m_params.lambda+solution.lambda, score_new);
+		}
+		else {
+			Logger::debug("\t%f", score_new);
+		}
+		if (score_new > score_old) {
+			Logger::warning("Not convergent!");
+		}
+		else if (fabs(score_new - score_old) > 0.01) {
+			continue;
+		}
+		if (!m_params.annealing) return true;
+		solution.lambda *= m_params.annealing_rate;
+		if (solution.lambda <= 0.01) return true;
+		solution.round_score = HUGE_VAL;
+	}
+	return false;
+}
+
+void PairAlign::_finishStart(AlignSolution &solution)
+{
+	double *translation = solution.translation, (*rotation)[3] = solution.rotation;
+
+	solution.finished = true;
+	solution.score = solveMaxMatch(translation, rotation, solution.alignment, m_params.lambda, &solution.potential);
+	solution.align_num = _getAlignNum(solution.alignment);
+	solution.rmsd = m_chain_a->getRMSD(*m_chain_b, translation, rotation, solution.alignment);
+}
+
+int PairAlign::_getAlignNum(const vector<int> &alignment)
+{
+	int align_num, i;
+	align_num = 0;
+	for (i=0; i<m_length_a; i++) {
+		if (alignment[i] >= 0) {
+			align_num++;
+		}
+	}
+	return align_num;
+}
+
+int PairAlign::_getBreakNum(const vector<int> &alignment)
+{
+	int break_num, i;
+	bool in_break;
+	break_num = 0;
+	if (alignment[0] < 0) {
+		in_break = true;
+	}
+	else {
+		in_break = false;
+	}
+	for (i=1; i<m_length_a; i++) {
+		if (in_break) {
+			if (alignment[i] >= 0) in_break = false;
+		}
+		else if (alignment[i] < 0) {
+			in_break = true;
+			break_num++;
+		}
+		else if (alignment[i] != alignment[i-1]+1 && alignment[i] != alignment[i-1]-1) {
+			break_num++;
+		}
+	}
+	if (in_break && break_num > 0) break_num--;
+	return break_num;
+}
+
+int PairAlign::_getPermuNum(const vector<int> &alignment)
+{
+	int permu_num, i, j;
+	permu_num = 0;
+	j = -1;
+	for (i=0; i<m_length_a; i++) {
+		if (alignment[i] >= 0) {
+			if (alignment[i] < j) {
+				permu_num++;
+			}
+			j = alignment[i];
+		}
+	}
+	return permu_num;
+}
+
+double PairAlign::_getSequenceIdentity(const vector<int> &alignment)
+{
+	int i, s, n;
+	double sequence_identity;
+	s = 0;
+	n = 0;
+	for (i=0; i<m_length_a; i++) {
+		if (alignment[i] >= 0) {
+			if ((*m_chain_a)[i].isIdenticalResidue((*m_chain_b)[alignment[i]])) s++;
+			n++;
+		}
+	}
+	sequence_identity = (double)s / n;
+	return sequence_identity;
+}
@@ -1,66 +1,196 @@
-
-#ifndef __PAIRALIGN_H
-#define __PAIRALIGN_H
-
-
-#include "AlignParams.h"
-#include "ProteinChain.h"
-
-
-class PairAlign {
-	ProteinChain *m_chain_a, *m_chain_b;
-	int m_length_a, m_length_b;
-
-	vector<int> m_alignment;
-	double m_translation[3], m_rotation[3][3];
-	int m_align_num, m_break_num, m_permu_num;
-	double m_rmsd, m_score, m_sequence_identity;
-
-	AlignParams m_params;
-
-	vector<vector<double> > m_weights;
-
-public:
-	PairAlign(ProteinChain *chain_a = NULL, ProteinChain *chain_b = NULL);
-
-	double rmsd() const { return m_rmsd; }
-	int align_num() const { return m_align_num; }
-	int alignment(int i) const { return m_alignment[i]; }
-
-	void setChain(int i, ProteinChain *chain);
-	void setParams(const AlignParams &params) { m_params = params; }
-
-	double align();
-	double alignBNB();
-	double alignITER();
-
-	double continueAlign();
-	void postProcess();
-	double postAlign(bool seq_order = false);
-
-	bool getStart(int index, vector<int> &alignment);
-	void initWeights();
-
-	double evaluate(const string &filename);
-	double improve(const string &filename);
-
-	void setSolution(const double translation[3], const double rotation[3][3], const vector<int> &alignment);
-
-	bool solveLeastSquare(double translation[3], double rotation[3][3], vector<int> &alignment);
-	double solveMaxMatch(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda);
-	double solveMaxAlign(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda);
-
-	void writePDBFile(const string &filename) const;
-	void writeSolutionFile(const string &filename) const;
-
-private:
-	int _getAlignNum(const vector<int> &alignment);
-	int _getBreakNum(const vector<int> &alignment);
-	int _getPermuNum(const vector<int> &alignment);
-	double _getSequenceIdentity(const vector<int> &alignment);
-
-	friend class MultiAlign;
-};
-
-
-#endif // __PAIRALIGN_H
+
+#ifndef __PAIRALIGN_H
+#define __PAIRALIGN_H
+
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include "AlignParams.h"
+#include "ProteinChain.h"
+#include "SpatialGrid.h"
+#include "DaryHeap.h"
+#include "ThreadPool.h"
+
+
+struct AlignSolution {
+	double translation[3], rotation[3][3];
+	vector<int> alignment;
+	vector<double> potential;
+	double initial_rmsd, rmsd, score;
+	int align_num;
+	bool skipped;
+	bool started, finished, dropped;
+	double lambda, round_score;						// Annealing offset and score of the last round
+	double race_score;								// Score ranking the start in a race
+};
+
+
+class FibHeapQueue;
+
+
+// rows of the sequential alignment in the precision it runs in
+
+template <class Real>
+struct AlignRows {
+	Vector<Real> weight, score, upper;				// Rows of the full table
+	Vector<Real> forward, backward;					// Rows of the linear memory method
+};
+
+
+// buffers of the solvers, each thread keeps one and reuses it for every call
+
+struct AlignWorkspace {
+	vector<int> active_start, active_index;			// Active pairs of the current transformation
+	vector<double> weight;
+	Vector<double> x, y, z;							// Transformed coordinates of chain a
+	SpatialGrid grid;
+	vector<int> neighbors;
+	vector<double> distances;
+	vector<pair<int, double> > pairs;
+	Vector<double> norm_a, tile;					// Dense distances of all pairs
+	DaryHeap heap;									// Matching from scratch
+	boost::shared_ptr<FibHeapQueue> fib_heap;		// Reference queue, made on first use
+	Vector<double> sink_weight;
+	Vector<bool> match_free, label_free;
+	Vector<int> match_edge, backtrack, backtrack_edge;
+	vector<int> match_b, res_start, res_to, res_edge;	// Repair of the previous matching
+	vector<double> res_cost, pi, dist;
+	vector<int> pred, pred_edge, queue, visited, cycle, cycle_tail;
+	vector<bool> queued;
+	vector<int> diagonals, band_start;				// Sequential alignment
+	Vector<unsigned char> codes;
+	AlignRows<float> rows_single;
+	AlignRows<double> rows_double;
+
+	AlignRows<float> &rows(float) { return rows_single; }
+	AlignRows<double> &rows(double) { return rows_double; }
+};
+
+
+struct BNBSearch;
+struct BNBTask;
+class Superposition;
+
+
+class PairAlign {
+	ProteinChain *m_chain_a, *m_chain_b;
+	int m_length_a, m_length_b;
+
+	vector<int> m_alignment;
+	double m_translation[3], m_rotation[3][3];
+	int m_align_num, m_break_num, m_permu_num;
+	double m_rmsd, m_score, m_sequence_identity;
+
+	boost::posix_time::ptime m_deadline;			// End of the time limit of align()
+	bool m_truncated;								// Whether the time limit was reached
+	boost::mutex m_mutex;							// Guards m_truncated
+
+	AlignParams m_params;
+
+	DenseMatrix<double> m_weights;					// Weights of residue pairs, indexed by [b][a]
+	DenseMatrix<float> m_weights_single;			// Weights used in single precision
+	vector<pair<int, int> > m_seeds;				// Fragment pairs of initial solutions
+
+	static boost::thread_specific_ptr<AlignWorkspace> m_workspace;
+	static ThreadPool m_pool;
+
+public:
+	PairAlign(ProteinChain *chain_a = NULL, ProteinChain *chain_b = NULL);
+
+	double rmsd() const { return m_rmsd; }
+	bool truncated() const { return m_truncated; }
+	int align_num() const { return m_align_num; }
+	int alignment(int i) const { return m_alignment[i]; }
+
+	void setChain(int i, ProteinChain *chain);
+	void setParams(const AlignParams &params) { m_params = params; }
+
+	double align();
+	double alignBNB();
+	double alignITER();
+
+	double continueAlign();
+	void postProcess();
+	double postAlign(bool seq_order = false);
+
+	bool getStart(int index, vector<int> &alignment);
+	void initSeeds();
+	void initWeights();
+
+	void benchmark(int repeat);
+
+	double evaluate(const string &filename);
+	double improve(const string &filename);
+
+	void setSolution(const double translation[3], const double rotation[3][3], const vector<int> &alignment);
+
+	bool solveLeastSquare(double translation[3], double rotation[3][3], vector<int> &alignment, double *rmsd = NULL);
+	double solveMaxMatch(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda,
+						 vector<double> *potential = NULL);
+	double solveMaxAlign(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda);
+
+	void writePDBFile(const string &filename) const;
+	void writeSolutionFile(const string &filename) const;
+
+private:
+	void _alignStart(vector<AlignSolution> &solutions, const vector<int> &starts, int round_num, int k);
+	bool _iterateStart(AlignSolution &solution, int round_num);
+	void _finishStart(AlignSolution &solution);
+	void _searchBNB(BNBSearch *search, int worker);
+	void _branchBNB(BNBSearch *search, int worker, BNBTask &task);
+	void _donateBNB(BNBSearch *search, int worker, const vector<int> &alignment, int index,
+					const vector<vector<int> > &branches, const vector<int> &next, vector<bool> &donated);
+	void _getBranches(BNBSearch *search, const vector<int> &alignment, const vector<bool> &occupied,
+					  const Superposition &superposition, int index, vector<int> &branches);
+	static AlignWorkspace &_getWorkspace();
+	bool _timeout();
+	void _addPair(Superposition &superposition, int a, int b, bool weighted = true);
+	void _validate();
+
+	double _getWeight(int a, int b) const {
+		return m_params.single_precision ? m_weights_single[b][a] : m_weights[b][a];
+	}
+	template <class Real>
+	void _fillWeights(DenseMatrix<Real> &weights, Real value);
+	template <class Real>
+	void _initWeights(DenseMatrix<Real> &weights);
+
+	void _getInnerDistance(const ProteinChain &chain, DenseMatrix<double> &distance);
+	void _getBandDistance(const ProteinChain &chain, int width, vector<vector<double> > &band);
+	int _getFragmentKey(const vector<vector<double> > &band, int i, int f, int shift);
+	double _getFragmentDistance(const vector<vector<double> > &band_a, const vector<vector<double> > &band_b, int i, int j, int f);
+	double _getKeyDistance(const vector<vector<double> > &band_a, const vector<vector<double> > &band_b, int i, int j, int f);
+	void _addBandDistance(double a, const double *b, double factor, double *sum, int n);
+	void _getDensePairs(double lambda, vector<int> &active_start, vector<int> &active_index, vector<double> &distance);
+	void _getActivePairs(const double translation[3], const double rotation[3][3], double lambda,
+						 vector<int> &active_start, vector<int> &active_index, vector<double> &distance);
+
+	bool _repairMatch(const vector<int> &active_start, const vector<int> &active_index, const vector<double> &weight,
+					  vector<int> &alignment, int *match_edge, vector<double> *potential);
+
+	template <class Heap>
+	double _solveMaxMatch(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda,
+						  vector<double> *potential, Heap &heap);
+	template <class Real>
+	double _solveMaxAlign(double translation[3], double rotation[3][3], vector<int> &alignment, double lambda);
+	template <class Real>
+	double _solveMaxAlignLinear(const vector<int> &active_start, const vector<int> &active_index, const vector<double> &pair_weight,
+								vector<int> &alignment, Vector<Real> &weight);
+	template <class Real>
+	Real _alignLinear(int begin_b, int end_b, int begin_a, int end_a,
+					  const vector<int> &active_start, const vector<int> &active_index, const vector<double> &pair_weight,
+					  vector<int> &alignment, Vector<Real> &weight, Vector<Real> &forward, Vector<Real> &backward);
+
+	int _getAlignNum(const vector<int> &alignment);
+	int _getBreakNum(const vector<int> &alignment);
+	int _getPermuNum(const vector<int> &alignment);
+	double _getSequenceIdentity(const vector<int> &alignment);
+
+	friend class MultiAlign;
+};
+
+
+#endif // __PAIRALIGN_H
@@ -1,299 +1,435 @@
-
-#include <map>
-#include <numeric>
-#include <limits>
-
-#include "Utils.h"
-#include "Matrix.h"
-#include "ProteinChain.h"
-
-#include "MemLeak.h"
-
-
-////////////////////////////////
-//
-// class ProteinChain
-
-ProteinChain::ProteinChain()
-{
-	int i;
-	m_pdb = NULL;
-	m_chain_id = 0;
-	m_pocket_id = 0;
-	m_range[0] = m_range[1] = 0;
-	m_is_backbone = true;
-	for (i=0; i<6; i++) m_name[i] = 0;
-	for (i=0; i<5; i++) m_id_code[i] = 0;
-	for (i=0; i<10; i++) m_dep_date[i] = 0;
-	for (i=0; i<41; i++) m_classification[i] = 0;
-}
-
-ProteinChain::~ProteinChain()
-{
-	clearData();
-}
-
-void ProteinChain::setChainID(char cid)
-{
-	if (cid >= 'a' && cid <= 'z') cid += 'A' - 'a';
-	if (cid == '_') cid = ' ';
-	m_chain_id = cid;
-}
-
-void ProteinChain::setPocketID(int pid)
-{
-	m_pocket_id = pid;
-}
-
-void ProteinChain::setRange(int start, int end)
-{
-	m_range[0] = start;
-	m_range[1] = end;
-}
-
-void ProteinChain::setBackbone(bool enable)
-{
-	m_is_backbone = enable;
-}
-
-void ProteinChain::getChain(PDB *pdb, char cid)
-{
-	int i;
-
-	if (pdb != NULL) setPDB(pdb);
-	if (cid != 0) setChainID(cid);
-
-	clearData();
-
-	strcpy(m_id_code, m_pdb->id_code());
-	strcpy(m_dep_date, m_pdb->dep_date());
-	strcpy(m_classification, m_pdb->classification());
-	if (m_chain_id == 0) m_chain_id = m_pdb->getChainID(1);
-	if (m_chain_id < -1) {
-		Logger::error("Can not find valid chain in PDB file %s!", m_pdb->filename());
-		exit(1);
-	}
-	strcpy(m_name, m_id_code);
-	if (m_chain_id != ' ') strncat(m_name, &m_chain_id, 1);
-	else strcat(m_name, "_");
-
-	for (i=0; i<m_pdb->atoms().size(); ++i) {
-		if (_filterChain(m_pdb->atoms()[i])) {
-			m_atoms.push_back(m_pdb->atoms()[i]);
-		}
-	}
-	if (m_atoms.empty())
-	{
-		Logger::warning("Empty chain! PDB file: %s, Chain ID: %c!", m_pdb->filename(), m_chain_id);
-	}
-
-	Logger::debug("Length of the protein chain %s:%c is %d", id_code(), chain_id(), length());
-}
-
-void ProteinChain::getAllChains(PDB *pdb)
-{
-	setChainID(-1);
-	getChain(pdb);
-}
-
-void ProteinChain::getPocketChain(PDB *pdb, int pid)
-{
-	int res_seq, i;
-	map<int, int> atoms;
-	map<int, vector<double> > coords;
-	map<int, vector<double> >::iterator ci;
-
-	if (pdb != NULL) setPDB(pdb);
-	if (pid != 0) setPocketID(pid);
-
-	if (m_pocket_id == 0) m_pocket_id = 1;
-	if (m_pocket_id < -1) {
-		Logger::error("Can not find valid pocket in POC file %s!", m_pdb->filename());
-		exit(1);
-	}
-	if (m_chain_id == 0) m_chain_id = m_pdb->getChainID(1);
-	if (m_chain_id < -1) {
-		Logger::error("Can not find valid chain in POC file %s!", m_pdb->filename());
-		exit(1);
-	}
-	strcpy(m_name, "POC");
-
-	for (i=0; i<m_pdb->atoms().size(); ++i) {
-		if (_filterPocket(m_pdb->atoms()[i])) {
-			res_seq = m_pdb->atoms()[i].res_seq();
-			atoms[res_seq] = i;
-			coords[res_seq].resize(4);
-			coords[res_seq][0] += m_pdb->atoms()[i][0];
-			coords[res_seq][1] += m_pdb->atoms()[i][1];
-			coords[res_seq][2] += m_pdb->atoms()[i][2];
-			coords[res_seq][3] += 1.0;
-		}
-	}
-
-	m_atoms.resize(coords.size());
-	ci = coords.begin();
-	for (i=0; i<m_atoms.size(); ++i) {
-		m_atoms[i] = m_pdb->atoms()[atoms[ci->first]];
-		m_atoms[i][0] = ci->second[0] / ci->second[4];
-		m_atoms[i][1] = ci->second[1] / ci->second[4];
-		m_atoms[i][2] = ci->second[2] / ci->second[4];
-		++ci;
-	}
-	if (m_atoms.empty())
-	{
-		Logger::warning("Empty pocket chain! Pocket file: %s, Pocket ID: %d!", m_pdb->filename(), m_pocket_id);
-	}
-}
-
-void ProteinChain::clearData()
-{
-	m_name[0] = 0;
-	m_id_code[0] = 0;
-	m_dep_date[0] = 0;
-	m_classification[0] = 0;
-	m_atoms.clear();
-}
-
-void ProteinChain::writeChainFile(const char *filename)
-{
-	FILE *fp;
-	int i;
-
-	if ((fp = fopen(filename, "w")) == NULL) {
-		Logger::error("Can not open the file: %s\n", filename);
-		exit(1);
-	}
-
-	fprintf(fp, "%d\n", length());
-
-	for (i=0; i<length(); i++) {
-		fprintf(fp, "%8.3f %8.3f %8.3f\n", m_atoms[i][0], m_atoms[i][1], m_atoms[i][2]);
-	}
-
-	fclose(fp);
-}
-
-void ProteinChain::writeChainCode(FILE *fp)
-{
-	int i;
-
-	for (i=0; i<length(); i++) {
-		fprintf(fp, "%c", m_atoms[i].resCode());
-	}
-}
-
-void ProteinChain::writePDBModel(FILE *fp, int model, bool fullchain, const double translation[3], const double rotation[3][3])
-{
-	ProteinChain *chain;
-	if (m_pocket_id == 0 && fullchain) {
-		chain = new ProteinChain;
-		chain->setBackbone(false);
-		chain->getChain(m_pdb, m_chain_id);
-	}
-	else {
-		chain = this;
-	}
-	chain->_writePDBModel(fp, model, translation, rotation);
-	if (m_pocket_id == 0 && fullchain) delete chain;
-}
-
-double **ProteinChain::getMatrix()
-{
-	double **matrix = Matrix<double>::alloc(length(), 3);
-	int i, j;
-	for (i=0; i<length(); i++) {
-		for (j=0; j<3; j++) {
-			matrix[i][j] = m_atoms[i][j];
-		}
-	}
-	return matrix;
-}
-
-double **ProteinChain::getMatrix(const double translation[3], const double rotation[3][3])
-{
-	double **matrix = Matrix<double>::alloc(length(), 3);
-	int i, j, k;
-	for (i=0; i<length(); i++) {
-		for (j=0; j<3; j++) {
-			matrix[i][j] = translation[j];
-		}
-	}
-	for (i=0; i<length(); i++) {
-		for (j=0; j<3; j++) {
-			for (k=0; k<3; k++) {
-				matrix[i][j] += rotation[j][k] * m_atoms[i][k];
-			}
-		}
-	}
-	return matrix;
-}
-
-double ProteinChain::getRMSD(const ProteinChain &chain, const double translation[3], const double rotation[3][3], const vector<int> &alignment)
-{
-	double **matrix = getMatrix(translation, rotation);
-	double rmsd, dist;
-	int i, j, n;
-	rmsd = 0;
-	n = 0;
-	for (i=0; i<length(); i++) {
-		if (alignment[i] >= 0 && alignment[i] < chain.length()) {
-			for (j=0; j<3; j++) {
-				dist = matrix[i][j] - chain[alignment[i]][j];
-				rmsd += dist * dist;
-			}
-			n++;
-		}
-	}
-	if (n > 0) {
-		rmsd = sqrt(rmsd / n);
-	}
-	Matrix<double>::free(matrix);
-	return rmsd;
-}
-
-void ProteinChain::_writePDBModel(FILE *fp, int model, const double translation[3], const double rotation[3][3])
-{
-	double **matrix;
-	int i;
-	if (model > 0) fprintf(fp, "MODEL     %4d%66c\n", model, ' ');
-	if (translation != NULL && rotation != NULL) {
-		matrix = getMatrix(translation, rotation);
-	}
-	else {
-		matrix = getMatrix();
-	}
-	for (i=0; i<length(); i++) {
-		fprintf(fp, "ATOM  %5d %4s %3s %c%4d    %8.3f%8.3f%8.3f%26c\n",
-			m_atoms[i].serial(),
-			m_atoms[i].name(),
-			m_atoms[i].res_name(),
-			m_atoms[i].chain_id(),
-			m_atoms[i].res_seq(),
-			matrix[i][0],
-			matrix[i][1],
-			matrix[i][2], ' ');
-		if ((i == length()-1) || (m_atoms[i].chain_id() != m_atoms[i+1].chain_id())) {
-			fprintf(fp, "TER   %5d      %3s %c%4d%54c\n",
-				m_atoms[i].serial()+1,
-				m_atoms[i].res_name(),
-				m_atoms[i].chain_id(),
-				m_atoms[i].res_seq(), ' ');
-		}
-	}
-	Matrix<double>::free(matrix);
-	if (model > 0) fprintf(fp, "ENDMDL%74c\n", ' ');
-}
-
-inline bool ProteinChain::_filterChain(const PDBAtom &atom) const
-{
-	return ((atom.isCa() || !m_is_backbone)
-			&& (atom.chain_id() == m_chain_id || m_chain_id == -1)
-			&& (atom.res_seq() >= m_range[0] || m_range[0] <= 0)
-			&& (atom.res_seq() <= m_range[1] || m_range[1] <= 0));
-}
-
-inline bool ProteinChain::_filterPocket(const PDBAtom &atom) const
-{
-	return ((atom.pocket_id() == m_pocket_id || m_pocket_id == -1)
-			&& (atom.chain_id() == m_chain_id || m_chain_id == -1));
-}
+
+#include <map>
+#include <numeric>
+#include <limits>
+
+#include "Utils.h"
+#include "Matrix.h"
+#include "ProteinChain.h"
+#include "ChainDB.h"
+
+#include "MemLeak.h"
+
+
+// copy a string into a field of the given size, cut to fit and terminated
+
+static void copy_field(char *field, size_t size, const char *s)
+{
+	size_t n;
+	n = min(strlen(s), size - 1);
+	memcpy(field, s, n);
+	field[n] = 0;
+}
+
+
+////////////////////////////////
+//
+// class ProteinChain
+
+ProteinChain::ProteinChain()
+{
+	int i;
+	m_pdb = NULL;
+	m_chain_id = 0;
+	m_pocket_id = 0;
+	m_range[0] = m_range[1] = 0;
+	m_is_backbone = true;
+	for (i=0; i<6; i++) m_name[i] = 0;
+	for (i=0; i<5; i++) m_id_code[i] = 0;
+	for (i=0; i<10; i++) m_dep_date[i] = 0;
+	for (i=0; i<41; i++) m_classification[i] = 0;
+}
+
+ProteinChain::~ProteinChain()
+{
+	clearData();
+}
+
+void ProteinChain::setChainID(char cid)
+{
+	if (cid >= 'a' && cid <= 'z') cid += 'A' - 'a';
+	if (cid == '_') cid = ' ';
+	m_chain_id = cid;
+}
+
+void ProteinChain::setPocketID(int pid)
+{
+	m_pocket_id = pid;
+}
+
+void ProteinChain::setRange(int start, int end)
+{
+	m_range[0] = start;
+	m_range[1] = end;
+}
+
+void ProteinChain::setBackbone(bool enable)
+{
+	m_is_backbone = enable;
+}
+
+// the atoms to read from a PDB file for this chain, 0 as chain identifier
+// keeps the first chain
+
+PDBFilter ProteinChain::getFilter() const
+{
+	PDBFilter filter;
+	filter.chain_id = m_chain_id;
+	filter.chain_index = 1;
+	filter.backbone = m_is_backbone;
+	filter.range[0] = m_range[0];
+	filter.range[1] = m_range[1];
+	return filter;
+}
+
+// index of the chain in its PDB file counted from 1, 0 if it has no PDB file
+
+int ProteinChain::getChainIndex() const
+{
+	return (m_pdb != NULL) ? m_pdb->getChainIndex(m_chain_id) : 0;
+}
+
+void ProteinChain::getChain(PDB *pdb, char cid)
+{
+	int i;
+
+	if (pdb != NULL) setPDB(pdb);
+	if (cid != 0) setChainID(cid);
+
+	clearData();
+
+	strcpy(m_id_code, m_pdb->id_code());
+	strcpy(m_dep_date, m_pdb->dep_date());
+	strcpy(m_classification, m_pdb->classification());
+	if (m_chain_id == 0) m_chain_id = m_pdb->getChainID(1);
+	if (m_chain_id < -1) {
+		Logger::error("Can not find valid chain in PDB file %s!", m_pdb->filename());
+		exit(1);
+	}
+	strcpy(m_name, m_id_code);
+	if (m_chain_id != ' ') strncat(m_name, &m_chain_id, 1);
+	else strcat(m_name, "_");
+
+	for (i=0; i<m_pdb->atoms().size(); ++i) {
+		if (_filterChain(m_pdb->atoms()[i])) {
+			m_atoms.push_back(m_pdb->atoms()[i]);
+		}
+	}
+	if (m_atoms.empty())
+	{
+		Logger::warning("Empty chain! PDB file: %s, Chain ID: %c!", m_pdb->filename(), m_chain_id);
+	}
+	updateCoords();
+
+	Logger::debug("Length of the protein chain %s:%c is %d", id_code(), chain_id(), length());
+}
+
+// load the chain from a record of a chain database, the residues out of the
+// range are skipped as when reading a PDB file
+
+void ProteinChain::getChain(const ChainDBRecord &record)
+{
+	const boost::int32_t *coords[3], *serial, *res_seq;
+	const char *res_name;
+	PDBAtom atom;
+	int n, i, k;
+
+	m_pdb = NULL;
+	clearData();
+
+	copy_field(m_id_code, sizeof(m_id_code), record.id_code);
+	copy_field(m_dep_date, sizeof(m_dep_date), record.dep_date);
+	copy_field(m_classification, sizeof(m_classification), record.classification);
+	m_chain_id = record.chain_id;
+	strcpy(m_name, m_id_code);
+	if (m_chain_id != ' ') strncat(m_name, &m_chain_id, 1);
+	else strcat(m_name, "_");
+
+	n = record.length;
+	coords[0] = (const boost::int32_t *) (&record + 1);
+	coords[1] = coords[0] + n;
+	coords[2] = coords[1] + n;
+	serial = coords[2] + n;
+	res_seq = serial + n;
+	res_name = (const char *) (res_seq + n);
+	strcpy(atom.m_name, " CA ");
+	atom.m_chain_id = m_chain_id;
+	m_atoms.reserve(n);
+	for (i=0; i<n; i++) {
+		atom.m_serial = serial[i];
+		atom.m_res_seq = res_seq[i];
+		strncpy(atom.m_res_name, res_name + 3 * i, 3);
+		for (k=0; k<3; k++) {
+			atom.m_coord[k] = coords[k][i] / 1000.0;
+		}
+		if (_filterChain(atom)) m_atoms.push_back(atom);
+	}
+	if (m_atoms.empty())
+	{
+		Logger::warning("Empty chain! Chain database record: %s, Chain ID: %c!", m_id_code, chain_id());
+	}
+	updateCoords();
+
+	Logger::debug("Length of the protein chain %s:%c is %d", id_code(), chain_id(), length());
+}
+
+void ProteinChain::getAllChains(PDB *pdb)
+{
+	setChainID(-1);
+	getChain(pdb);
+}
+
+void ProteinChain::getPocketChain(PDB *pdb, int pid)
+{
+	int res_seq, i;
+	map<int, int> atoms;
+	map<int, vector<double> > coords;
+	map<int, vector<double> >::iterator ci;
+
+	if (pdb != NULL) setPDB(pdb);
+	if (pid != 0) setPocketID(pid);
+
+	if (m_pocket_id == 0) m_pocket_id = 1;
+	if (m_pocket_id < -1) {
+		Logger::error("Can not find valid pocket in POC file %s!", m_pdb->filename());
+		exit(1);
+	}
+	if (m_chain_id == 0) m_chain_id = m_pdb->getChainID(1);
+	if (m_chain_id < -1) {
+		Logger::error("Can not find valid chain in POC file %s!", m_pdb->filename());
+		exit(1);
+	}
+	strcpy(m_name, "POC");
+
+	for (i=0; i<m_pdb->atoms().size(); ++i) {
+		if (_filterPocket(m_pdb->atoms()[i])) {
+			res_seq = m_pdb->atoms()[i].res_seq();
+			atoms[res_seq] = i;
+			coords[res_seq].resize(4);
+			coords[res_seq][0] += m_pdb->atoms()[i][0];
+			coords[res_seq][1] += m_pdb->atoms()[i][1];
+			coords[res_seq][2] += m_pdb->atoms()[i][2];
+			coords[res_seq][3] += 1.0;
+		}
+	}
+
+	m_atoms.resize(coords.size());
+	ci = coords.begin();
+	for (i=0; i<m_atoms.size(); ++i) {
+		m_atoms[i] = m_pdb->atoms()[atoms[ci->first]];
+		m_atoms[i][0] = ci->second[0] / ci->second[3];
+		m_atoms[i][1] = ci->second[1] / ci->second[3];
+		m_atoms[i][2] = ci->second[2] / ci->second[3];
+		++ci;
+	}
+	if (m_atoms.empty())
+	{
+		Logger::warning("Empty pocket chain! Pocket file: %s, Pocket ID: %d!", m_pdb->filename(), m_pocket_id);
+	}
+	updateCoords();
+}
+
+void ProteinChain::clearData()
+{
+	m_name[0] = 0;
+	m_id_code[0] = 0;
+	m_dep_date[0] = 0;
+	m_classification[0] = 0;
+	m_atoms.clear();
+	updateCoords();
+}
+
+// copy the coordinates of atoms into the arrays by axis, which must be redone
+// whenever atoms are modified through operator []
+
+void ProteinChain::updateCoords()
+{
+	int i, k;
+	for (k=0; k<3; k++) {
+		m_coords[k].resize(length());
+		for (i=0; i<length(); i++) {
+			m_coords[k][i] = m_atoms[i][k];
+		}
+	}
+}
+
+// append the chain to a chain database as a record, see ChainDB.h, and return
+// the number of bytes written, coordinates are rounded to milli-Angstrom which
+// is the precision of PDB files
+
+size_t ProteinChain::writeRecord(FILE *fp) const
+{
+	ChainDBRecord record;
+	vector<boost::int32_t> values;
+	vector<char> names;
+	size_t size;
+	int n, i, k;
+
+	n = length();
+	memset(&record, 0, sizeof(record));
+	record.length = n;
+	copy_field(record.id_code, sizeof(record.id_code), m_id_code);
+	record.chain_id = m_chain_id;
+	copy_field(record.dep_date, sizeof(record.dep_date), m_dep_date);
+	copy_field(record.classification, sizeof(record.classification), m_classification);
+
+	// records are padded to keep the next one 8-byte aligned
+	size = sizeof(record) + (23 * n + 7) / 8 * 8;
+	values.resize(5 * n);
+	names.resize(size - sizeof(record) - 20 * n, 0);
+	for (i=0; i<n; i++) {
+		for (k=0; k<3; k++) {
+			values[k * n + i] = (boost::int32_t) floor(m_atoms[i][k] * 1000 + 0.5);
+		}
+		values[3 * n + i] = m_atoms[i].serial();
+		values[4 * n + i] = m_atoms[i].res_seq();
+		memcpy(&names[3 * i], m_atoms[i].res_name(), min(strlen(m_atoms[i].res_name()), (size_t) 3));
+	}
+
+	fwrite(&record, sizeof(record), 1, fp);
+	if (!values.empty()) fwrite(&values[0], sizeof(boost::int32_t), values.size(), fp);
+	if (!names.empty()) fwrite(&names[0], 1, names.size(), fp);
+	return size;
+}
+
+void ProteinChain::writeChainCode(FILE *fp)
+{
+	int i;
+
+	for (i=0; i<length(); i++) {
+		fprintf(fp, "%c", m_atoms[i].resCode());
+	}
+}
+
+void ProteinChain::writePDBModel(FILE *fp, int model, bool fullchain, const double translation[3], const double rotation[3][3])
+{
+	ProteinChain *chain;
+	PDB *pdb;
+	PDBFilter filter;
+	pdb = NULL;
+	// a chain from a chain database has no PDB file, its CA atoms are written
+	if (m_pdb == NULL) fullchain = false;
+	if (m_pocket_id == 0 && fullchain) {
+		chain = new ProteinChain;
+		chain->setBackbone(false);
+		if (m_pdb->filtered()) {
+			// only the atoms of the alignment were read, so the chain is read again
+			pdb = new PDB;
+			filter = chain->getFilter();
+			filter.chain_id = m_chain_id;
+			pdb->readFile(m_pdb->filename(), &filter);
+			chain->getChain(pdb, m_chain_id);
+		}
+		else {
+			chain->getChain(m_pdb, m_chain_id);
+		}
+	}
+	else {
+		chain = this;
+	}
+	chain->_writePDBModel(fp, model, translation, rotation);
+	if (m_pocket_id == 0 && fullchain) delete chain;
+	delete pdb;
+}
+
+// transformed coordinates by axis, one independent loop per axis
+
+void ProteinChain::transform(const double translation[3], const double rotation[3][3], double *x, double *y, double *z) const
+{
+	const double *cx = m_coords[0].data(), *cy = m_coords[1].data(), *cz = m_coords[2].data();
+	double *t[3];
+	double r0, r1, r2, t0;
+	int n, i, k;
+	n = length();
+	t[0] = x;
+	t[1] = y;
+	t[2] = z;
+	for (k=0; k<3; k++) {
+		r0 = rotation[k][0];
+		r1 = rotation[k][1];
+		r2 = rotation[k][2];
+		t0 = translation[k];
+		for (i=0; i<n; i++) {
+			t[k][i] = r0 * cx[i] + r1 * cy[i] + r2 * cz[i] + t0;
+		}
+	}
+}
+
+// the transformation is applied on the fly, with the rotation kept in locals
+// and one sum per axis so the loop carries no temporary and no dependency
+// between the axes
+
+double ProteinChain::getRMSD(const ProteinChain &chain, const double translation[3], const double rotation[3][3], const vector<int> &alignment) const
+{
+	const double *cx = m_coords[0].data(), *cy = m_coords[1].data(), *cz = m_coords[2].data();
+	const double *dx = chain.m_coords[0].data(), *dy = chain.m_coords[1].data(), *dz = chain.m_coords[2].data();
+	double r00, r01, r02, r10, r11, r12, r20, r21, r22, t0, t1, t2;
+	double sx, sy, sz, ex, ey, ez;
+	int i, k, n, length_b;
+	r00 = rotation[0][0]; r01 = rotation[0][1]; r02 = rotation[0][2];
+	r10 = rotation[1][0]; r11 = rotation[1][1]; r12 = rotation[1][2];
+	r20 = rotation[2][0]; r21 = rotation[2][1]; r22 = rotation[2][2];
+	t0 = translation[0];
+	t1 = translation[1];
+	t2 = translation[2];
+	length_b = chain.length();
+	sx = sy = sz = 0;
+	n = 0;
+	for (i=0; i<length(); i++) {
+		k = alignment[i];
+		if (k >= 0 && k < length_b) {
+			ex = r00 * cx[i] + r01 * cy[i] + r02 * cz[i] + t0 - dx[k];
+			ey = r10 * cx[i] + r11 * cy[i] + r12 * cz[i] + t1 - dy[k];
+			ez = r20 * cx[i] + r21 * cy[i] + r22 * cz[i] + t2 - dz[k];
+			sx += ex * ex;
+			sy += ey * ey;
+			sz += ez * ez;
+			n++;
+		}
+	}
+	if (n > 0) {
+		return sqrt((sx + sy + sz) / n);
+	}
+	return 0;
+}
+
+void ProteinChain::_writePDBModel(FILE *fp, int model, const double translation[3], const double rotation[3][3])
+{
+	double coords[3];
+	int i;
+	if (model > 0) fprintf(fp, "MODEL     %4d%66c\n", model, ' ');
+	for (i=0; i<length(); i++) {
+		getCoords(i, translation, rotation, coords);
+		fprintf(fp, "ATOM  %5d %4s %3s %c%4d    %8.3f%8.3f%8.3f%26c\n",
+			m_atoms[i].serial(),
+			m_atoms[i].name(),
+			m_atoms[i].res_name(),
+			m_atoms[i].chain_id(),
+			m_atoms[i].res_seq(),
+			coords[0],
+			coords[1],
+			coords[2], ' ');
+		if ((i == length()-1) || (m_atoms[i].chain_id() != m_atoms[i+1].chain_id())) {
+			fprintf(fp, "TER   %5d      %3s %c%4d%54c\n",
+				m_atoms[i].serial()+1,
+				m_atoms[i].res_name(),
+				m_atoms[i].chain_id(),
+				m_atoms[i].res_seq(), ' ');
+		}
+	}
+	if (model > 0) fprintf(fp, "ENDMDL%74c\n", ' ');
+}
+
+inline bool ProteinChain::_filterChain(const PDBAtom &atom) const
+{
+	return ((atom.isCa() || !m_is_backbone)
+			&& (atom.chain_id() == m_chain_id || m_chain_id == -1)
+			&& (atom.res_seq() >= m_range[0] || m_range[0] <= 0)
+			&& (atom.res_seq() <= m_range[1] || m_range[1] <= 0));
+}
+
+inline bool ProteinChain::_filterPocket(const PDBAtom &atom) const
+{
+	return ((atom.pocket_id() == m_pocket_id || m_pocket_id == -1)
+			&& (atom.chain_id() == m_chain_id || m_chain_id == -1));
+}
@@ -1,71 +1,104 @@
-
-#ifndef __PROTEINCHAIN_H
-#define __PROTEINCHAIN_H
-
-
-#include <vector>
-#include <cstdio>
-
-#include "PDB.h"
-
-
-class ProteinChain {
-	PDB *m_pdb;
-	string m_raw_name;
-	char m_chain_id;								// Chain identifier
-	int m_pocket_id;
-	int m_range[2];
-	bool m_is_backbone;
-	char m_name[6];									// Name of chain
-	char m_id_code[5];								// This identifier is unique within PDB
-	char m_dep_date[10];							// Deposition date
-	char m_classification[41];						// Classifies the molecule(s)
-	vector<PDBAtom> m_atoms;						// Atoms
-
-public:
-	ProteinChain();
-	~ProteinChain();
-
-	PDBAtom &operator [](int i) { return m_atoms[i]; }
-	const PDBAtom &operator [](int i) const { return m_atoms[i]; }
-
-	const char *raw_name() const { return m_raw_name.c_str(); }
-	char chain_id() const { if (m_chain_id == ' ') return '_'; else return m_chain_id; }
-	int pocket_id() const { return m_pocket_id; }
-	int range(int i) const { return m_range[i]; }
-	int length() const { return m_atoms.size(); }
-	const char *name() const { return m_name; }
-	const char *id_code() const { return m_id_code; }
-	const char *dep_date() const { return m_dep_date; }
-	const char *classification() const { return m_classification; }
-
-	void setPDB(PDB *pdb) { m_pdb = pdb; }
-	void setRawName(const string &rname) { m_raw_name = rname; }
-	void setChainID(char cid);
-	void setPocketID(int pid);
-	void setRange(int start, int end);
-	void setBackbone(bool enable);
-
-	void getChain(PDB *pdb = NULL, char cid = 0);
-	void getAllChains(PDB *pdb = NULL);
-
-	void getPocketChain(PDB *pdb = NULL, int pid = 0);
-
-	void clearData();
-
-	void writeChainFile(const char *filename);
-	void writeChainCode(FILE *fp);
-	void writePDBModel(FILE *fp, int model = 0, bool fullchain = false, const double translation[3] = NULL, const double rotation[3][3] = NULL);
-
-	double **getMatrix();
-	double **getMatrix(const double translation[3], const double rotation[3][3]);
-	double getRMSD(const ProteinChain &chain, const double translation[3], const double rotation[3][3], const vector<int> &alignment);
-
-protected:
-	void _writePDBModel(FILE *fp, int model = 0, const double translation[3] = NULL, const double rotation[3][3] = NULL);
-	bool _filterChain(const PDBAtom &atom) const;
-	bool _filterPocket(const PDBAtom &atom) const;
-};
-
-
-#endif // __PROTEINCHAIN_H
+
+#ifndef __PROTEINCHAIN_H
+#define __PROTEINCHAIN_H
+
+
+#include <vector>
+#include <cstdio>
+
+#include "PDB.h"
+#include "Matrix.h"
+
+
+struct ChainDBRecord;
+
+
+class ProteinChain {
+	PDB *m_pdb;
+	string m_raw_name;
+	char m_chain_id;								// Chain identifier
+	int m_pocket_id;
+	int m_range[2];
+	bool m_is_backbone;
+	char m_name[6];									// Name of chain
+	char m_id_code[5];								// This identifier is unique within PDB
+	char m_dep_date[10];							// Deposition date
+	char m_classification[41];						// Classifies the molecule(s)
+	vector<PDBAtom> m_atoms;						// Atoms
+	Vector<double> m_coords[3];						// Coordinates of atoms by axis, for vectorized loops
+
+public:
+	ProteinChain();
+	~ProteinChain();
+
+	PDBAtom &operator [](int i) { return m_atoms[i]; }
+	const PDBAtom &operator [](int i) const { return m_atoms[i]; }
+
+	const char *raw_name() const { return m_raw_name.c_str(); }
+	char chain_id() const { if (m_chain_id == ' ') return '_'; else return m_chain_id; }
+	int pocket_id() const { return m_pocket_id; }
+	int range(int i) const { return m_range[i]; }
+	int length() const { return m_atoms.size(); }
+	const char *name() const { return m_name; }
+	const char *id_code() const { return m_id_code; }
+	const char *dep_date() const { return m_dep_date; }
+	const char *classification() const { return m_classification; }
+	const double *coords(int k) const { return m_coords[k].data(); }
+
+	void setPDB(PDB *pdb) { m_pdb = pdb; }
+	void setRawName(const string &rname) { m_raw_name = rname; }
+	void setChainID(char cid);
+	void setPocketID(int pid);
+	void setRange(int start, int end);
+	void setBackbone(bool enable);
+	PDBFilter getFilter() const;
+	int getChainIndex() const;
+
+	void getChain(PDB *pdb = NULL, char cid = 0);
+	void getChain(const ChainDBRecord &record);
+	void getAllChains(PDB *pdb = NULL);
+
+	void getPocketChain(PDB *pdb = NULL, int pid = 0);
+
+	void clearData();
+	void updateCoords();
+
+	size_t writeRecord(FILE *fp) const;
+	void writeChainCode(FILE *fp);
+	void writePDBModel(FILE *fp, int model = 0, bool fullchain = false, const double translation[3] = NULL, const double rotation[3][3] = NULL);
+
+	inline void getCoords(int i, const double translation[3], const double rotation[3][3], double coords[3]) const;
+	void transform(const double translation[3], const double rotation[3][3], double *x, double *y, double *z) const;
+	double getRMSD(const ProteinChain &chain, const double translation[3], const double rotation[3][3], const vector<int> &alignment) const;
+
+protected:
+	void _writePDBModel(FILE *fp, int model = 0, const double translation[3] = NULL, const double rotation[3][3] = NULL);
+	bool _filterChain(const PDBAtom &atom) const;
+	bool _filterPocket(const PDBAtom &atom) const;
+};
+
+
+// coordinates of atom i under a transformation, applied on the fly so that no
+// transformed copy of the chain is needed, or as they are if there is none
+
+inline void ProteinChain::getCoords(int i, const double translation[3], const double rotation[3][3], double coords[3]) const
+{
+	double x, y, z;
+	int k;
+	x = m_coords[0][i];
+	y = m_coords[1][i];
+	z = m_coords[2][i];
+	if (translation != NULL && rotation != NULL) {
+		for (k=0; k<3; k++) {
+			coords[k] = rotation[k][0] * x + rotation[k][1] * y + rotation[k][2] * z + translation[k];
+		}
+	}
+	else {
+		coords[0] = x;
+		coords[1] = y;
+		coords[2] = z;
+	}
+}
+
+
+#endif // __PROTEINCHAIN_H
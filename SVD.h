@@ -1,9 +0,0 @@
-
-#ifndef __SVD_H
-#define __SVD_H
-
-
-void svdcmp(double **a, int m, int n, double w[], double **v);
-
-
-#endif // __SVD_H
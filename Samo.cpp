@@ -1,274 +1,379 @@
-
-#include <iostream>
-#include <fstream>
-
-#include "Samo.h"
-#include "Options.h"
-
-#include "MemLeak.h"
-
-
-const char *Samo::m_version = "0.04.001";
-const char *Samo::m_year = "2009";
-
-
-Samo::Samo(int argc, char *argv[])
-{
-	po::options_description generics("Generic options");
-	generics.add_options()
-		("help,h", "Show help message")
-		("config,c", po::value<string>()->default_value("Samo.cfg"), "Configuration file")
-		;
-
-	po::options_description configs("Configurations");
-	configs.add_options()
-		("nologo", "Suppress logo and copyright information")
-		("debug,d", po::value<int>()->default_value(4), "Set debug level - 1: Error; 2: Warning; 3:Information; 4:Verbose; 5:Debug")
-		("pocket,p", "Align two protein pockets instead of protein chains")
-		("output-solution", po::value<string>(), "Output alignment result to a solution file")
-		("output-pdb", po::value<string>(), "Output alignment result to a PDB file")
-		;
-
-	po::options_description parameters("Parameters");
-	parameters.add_options()
-		("branch-and-bound,b", po::bool_switch(&m_params.branch_and_bound), "Use branch and bound method instead of iterative method")
-		("lambda,l", po::value<double>(&m_params.lambda)->default_value(6.0), "Parameter to balance two objective, smaller value for smaller RMSD")
-		("sequential-order", po::bool_switch(&m_params.sequential_order), "Require alignment with sequential order")
-		("heuristic-start", po::value<int>(&m_params.heuristic_start)->default_value(2), "Set heuristic levels for finding initial solutions")
-		("annealing", po::bool_switch(&m_params.annealing), "Enable annealing technique")
-		("annealing-initial", po::value<double>(&m_params.annealing_initial)->default_value(60.0), "Initial value for annealing")
-		("annealing-rate", po::value<double>(&m_params.annealing_rate)->default_value(0.4), "Cooling coefficient for annealing")
-		("weight-method,w", po::value<string>(&m_params.weight_method)->default_value("LS"), "Set weighted method")
-		;
-
-	po::options_description utilities("Utility options");
-	utilities.add_options()
-		("extract", "Extract chains data from the PDB files")
-		("evaluate", po::value<string>(), "Evaluate a given alignment")
-		("improve", po::value<string>(), "Improve a given alignment")
-		;
-
-	po::options_description hidden;
-	hidden.add_options()
-		("filename", po::value<vector<string> >(&m_filenames), "input files")
-		;
-
-	m_options.add(generics).add(configs).add(parameters).add(utilities).add(hidden);
-	m_visible_options.add(generics).add(configs).add(parameters).add(utilities);
-
-	po::positional_options_description p;
-	p.add("filename", -1);
-
-	po::options_description cmdline_options, file_options;
-	cmdline_options.add(generics).add(configs).add(parameters).add(utilities).add(hidden);
-	file_options.add(configs).add(parameters).add(utilities);
-
-	po::store(po::command_line_parser(argc, argv).options(cmdline_options).positional(p).run(), m_args);
-
-	ifstream ifs(m_args["config"].as<string>().c_str());
-	po::store(po::parse_config_file(ifs, file_options), m_args);
-
-	po::notify(m_args);
-
-//	conflicting_options(m_args, "convert", "compare");
-
-	parseOptions();
-	parseFileNames();
-}
-
-Samo::~Samo()
-{
-}
-
-void Samo::copyright()
-{
-	Logger::info("Samo - Protein Structure Alignment tool [Version %s]", m_version);
-	Logger::info("Copyright (C) ZHANGroup@APORC.ORG 2005-%s. All rights reserved.\n", m_year);
-}
-
-void Samo::usage()
-{
-	Logger::info("Usage 1: Samo [options ...] [{code|file}[:id[:start[:end]]] ...]\n");
-	Logger::info("  <code>  is the 4-character PDB assigned identifier");
-	Logger::info("  <file>  is the PDB filename");
-	Logger::info("  <id>    is the chain identifier in the PDB file");
-	Logger::info("  <start> is the start residue sequence number");
-	Logger::info("  <end>   is the end residue sequence number");
-	Logger::info("");
-	Logger::info("Usage 2: Samo -pocket [options ...] [file[:pid[:cid]] ...]\n");
-	Logger::info("  <file>  is the Pocket filename");
-	Logger::info("  <pid>   is the pocket identifier in the Pocket file");
-	Logger::info("  <cid>   is the chain identifier in the Pocket file");
-	Logger::info("");
-	if (Logger::log_level() >= Logger::log_level_info()) {
-		cout << m_visible_options << "\n\n";
-	}
-	Logger::info("Examples:");
-	Logger::info("\tSamo 1dhf:a 8dfr");
-	Logger::info("\tSamo pdb1dhf.ent:a pdb8dfr.ent");
-	Logger::info("\tSamo 1dhf:a:20:120 8dfr:_:50:150");
-}
-
-void Samo::printOptions()
-{
-	cout << "Used options (user specified):" << endl;
-	print_options(m_args, cout, DisplayOption::specified);
-	cout << "Used options (default):" << endl;
-	print_options(m_args, cout, DisplayOption::defaulted);
-	cout << endl;
-}
-
-void Samo::parseOptions()
-{
-	Logger::setLogLevel(m_args["debug"].as<int>());
-	if (!m_args.count("nologo")) {
-		copyright();
-	}
-	if (m_args.count("help") || !m_filenames.size()) {
-		usage();
-		exit(0);
-	}
-	if (Logger::isDebug()) {
-		printOptions();
-	}
-}
-
-void Samo::run()
-{
-	int i;
-	char filename[80];
-
-	if (m_args.count("extract")) {
-		for (i=0; i<m_chain_num; i++) {
-			strcpy(filename, m_chains[i].name());
-			strcat(filename, ".d");
-			m_chains[i].writeChainFile(filename);
-			Logger::info("Length of the protein chain %s is %d", m_chains[i].name(), m_chains[i].length());
-		}
-	}
-	else if (m_args.count("evaluate")) {
-		if (m_chain_num != 2) {
-			Logger::error("2 protein chains are required for evaluation!");
-			exit(1);
-		}
-		PairAlign palign(&m_chains[0], &m_chains[1]);
-		palign.setParams(m_params);
-		palign.evaluate(m_args["evaluate"].as<string>());
-		palign.postProcess();
-		output(palign);
-	}
-	else if (m_args.count("improve")) {
-		if (m_chain_num != 2) {
-			Logger::error("2 protein chains are required for improvement!");
-			exit(1);
-		}
-		PairAlign palign(&m_chains[0], &m_chains[1]);
-		palign.setParams(m_params);
-		palign.improve(m_args["improve"].as<string>());
-		palign.postProcess();
-		output(palign);
-	}
-	else if (m_chain_num <= 1) {
-		Logger::error("At least 2 protein chains are required for alignment!");
-		exit(1);
-	}
-	else if (m_chain_num == 2) {
-		Logger::beginTimer(1, "Pairwise alignment");
-		PairAlign palign(&m_chains[0], &m_chains[1]);
-		palign.setParams(m_params);
-		palign.align();
-		palign.postProcess();
-		Logger::endTimer(1);
-		output(palign);
-	}
-	else {
-		Logger::beginTimer(1, "Multiple alignment");
-		MultiAlign malign(m_chain_num);
-		malign.setParams(m_params);
-		for (i=0; i<m_chain_num; i++) {
-			malign.setChain(i, &m_chains[i]);
-		}
-		malign.align();
-		Logger::endTimer(1);
-		output(malign);
-	}
-}
-
-void Samo::parseFileNames()
-{
-	int i, start, end;
-	string filename;
-	vector<string> tokens;
-
-	m_chain_num = m_filenames.size();
-	m_pdbs.resize(m_chain_num);
-	m_chains.resize(m_chain_num);
-
-	if (!m_args.count("pocket")) {
-		for (i=0; i<m_chain_num; i++) {
-			m_chains[i].setRawName(m_filenames[i]);
-			string_tokenize(tokens, m_filenames[i], ":");
-			filename = tokens[0];
-			if (filename.find('.') == string::npos) {
-				filename += ".ent";
-				if (filename.compare(0, 3, "pdb") != 0) {
-					filename = "pdb" + filename;
-				}
-			}
-			m_pdbs[i].readFile(filename);
-			m_chains[i].setPDB(&m_pdbs[i]);
-			if (tokens.size() > 1) {
-				parseChainID(i, tokens[1]);
-				if (tokens.size() > 2) {
-					start = str2int(tokens[2]);
-					if (tokens.size() > 3) end = str2int(tokens[3]);
-					else end = 0;
-					m_chains[i].setRange(start, end);
-				}
-			}
-			m_chains[i].getChain();
-			if (m_chains[i].length() == 0) exit(1);
-		}
-	}
-	else {
-		for (i=0; i<m_chain_num; i++) {
-			m_chains[i].setRawName(m_filenames[i]);
-			string_tokenize(tokens, m_filenames[i], ":");
-			filename = tokens[0];
-			if (filename.find('.') == string::npos) {
-				filename += ".poc";
-// 				if (filename.compare(0, 3, "pdb") != 0) {
-// 					filename = "pdb" + filename;
-// 				}
-			}
-			m_pdbs[i].readPocket(filename);
-			m_chains[i].setPDB(&m_pdbs[i]);
-			if (tokens.size() > 1) {
-				parsePocketID(i, tokens[1]);
-				if (tokens.size() > 2) parseChainID(i, tokens[2]);
-			}
-			m_chains[i].getPocketChain();
-			if (m_chains[i].length() == 0) exit(1);
-		}
-	}
-}
-
-void Samo::parsePocketID(int i, const string &token)
-{
-	if (token[0] == '#') {
-		m_chains[i].setPocketID(m_pdbs[i].getPocketID(str2int(token.substr(1))));
-	}
-	else {
-		m_chains[i].setPocketID(str2int(token));
-	}
-}
-
-void Samo::parseChainID(int i, const string &token)
-{
-	if (token[0] == '#') {
-		m_chains[i].setChainID(m_pdbs[i].getChainID(str2int(token.substr(1))));
-	}
-	else {
-		m_chains[i].setChainID(token[0]);
-	}
+
+#include <iostream>
+#include <fstream>
+
+#include "Samo.h"
+#include "Options.h"
+
+#include "MemLeak.h"
+
+
+const char *Samo::m_version = "0.04.001";
+const char *Samo::m_year = "2009";
+
+
+Samo::Samo(int argc, char *argv[])
+{
+	po::options_description generics("Generic options");
+	generics.add_options()
+		("help,h", "Show help message")
+		("config,c", po::value<string>()->default_value("Samo.cfg"), "Configuration file")
+		;
+
+	po::options_description configs("Configurations");
+	configs.add_options()
+		("nologo", "Suppress logo and copyright information")
+		("debug,d", po::value<int>()->default_value(4), "Set debug level - 1: Error; 2: Warning; 3:Information; 4:Verbose; 5:Debug")
+		("pocket,p", "Align two protein pockets instead of protein chains")
+		("output-solution", po::value<string>(), "Output alignment result to a solution file")
+		("output-pdb", po::value<string>(), "Output alignment result to a PDB file")
+		("chain-db", po::value<string>(), "Chain database written by --extract, from which chains are loaded by code instead of PDB files")
+		;
+
+	po::options_description parameters("Parameters");
+	parameters.add_options()
+		("branch-and-bound,b", po::bool_switch(&m_params.branch_and_bound), "Use branch and bound method instead of iterative method")
+		("lambda,l", po::value<double>(&m_params.lambda)->default_value(6.0), "Parameter to balance two objective, smaller value for smaller RMSD")
+		("sequential-order", po::bool_switch(&m_params.sequential_order), "Require alignment with sequential order")
+		("heuristic-start", po::value<int>(&m_params.heuristic_start)->default_value(2), "Set heuristic levels for finding initial solutions")
+		("seed-method", po::value<string>(&m_params.seed_method)->default_value("grid"), "Set method of initial solutions - grid: blocks on the grid of heuristic levels; fragment: most similar fragment pairs")
+		("seed-budget", po::value<int>(&m_params.seed_budget)->default_value(8), "Set maximal number of initial solutions by fragment pairs")
+		("annealing", po::bool_switch(&m_params.annealing), "Enable annealing technique")
+		("annealing-initial", po::value<double>(&m_params.annealing_initial)->default_value(60.0), "Initial value for annealing")
+		("annealing-rate", po::value<double>(&m_params.annealing_rate)->default_value(0.4), "Cooling coefficient for annealing")
+		("race-rounds", po::value<int>(&m_params.race_rounds)->default_value(0), "Race the heuristic starts, dropping the worse half after every given number of rounds, 0 to run all starts fully")
+		("race-survivors", po::value<int>(&m_params.race_survivors)->default_value(1), "Set number of starts at which the race stops and the rest run fully")
+		("weight-method,w", po::value<string>(&m_params.weight_method)->default_value("LS"), "Set weighted method")
+		("threads,t", po::value<int>(&m_params.thread_num)->default_value(1), "Set number of threads for running heuristic starts, 0 for all cores")
+		("priority-queue", po::value<string>(&m_params.priority_queue)->default_value("dary"), "Set priority queue of the matching solver - dary: 4-ary heap; fib: Fibonacci heap")
+		("warm-start", po::value<bool>(&m_params.warm_start)->default_value(true), "Repair the previous matching instead of solving from scratch")
+		("single-precision", po::bool_switch(&m_params.single_precision), "Keep weights and dynamic programming scores in single precision")
+		("validate", po::bool_switch(&m_params.validate), "Check the single precision result against double precision, with --single-precision")
+		("align-memory", po::value<int>(&m_params.align_memory)->default_value(512), "Set memory limit in MB of the sequential alignment table, beyond which a linear memory method is used")
+		("band-width", po::value<int>(&m_params.band_width)->default_value(0), "Set initial half width of the band of sequential alignment, which may miss paths far off the band, 0 for the exact full table")
+		("time-limit", po::value<double>(&m_params.time_limit)->default_value(0), "Set time limit in seconds of aligning a pair, the best solution so far is kept, 0 for no limit")
+		;
+
+	po::options_description utilities("Utility options");
+	utilities.add_options()
+		("extract", "Extract chains data from the PDB files into the chain database, Samo.cdb if not given")
+		("evaluate", po::value<string>(), "Evaluate a given alignment")
+		("improve", po::value<string>(), "Improve a given alignment")
+		("benchmark", po::value<int>(), "Benchmark the priority queues of the matching solver with given repetitions")
+		;
+
+	po::options_description hidden;
+	hidden.add_options()
+		("filename", po::value<vector<string> >(&m_filenames), "input files")
+		;
+
+	m_options.add(generics).add(configs).add(parameters).add(utilities).add(hidden);
+	m_visible_options.add(generics).add(configs).add(parameters).add(utilities);
+
+	po::positional_options_description p;
+	p.add("filename", -1);
+
+	po::options_description cmdline_options, file_options;
+	cmdline_options.add(generics).add(configs).add(parameters).add(utilities).add(hidden);
+	file_options.add(configs).add(parameters).add(utilities);
+
+	po::store(po::command_line_parser(argc, argv).options(cmdline_options).positional(p).run(), m_args);
+
+	ifstream ifs(m_args["config"].as<string>().c_str());
+	po::store(po::parse_config_file(ifs, file_options), m_args);
+
+	po::notify(m_args);
+
+//	conflicting_options(m_args, "convert", "compare");
+
+	parseOptions();
+	parseFileNames();
+}
+
+Samo::~Samo()
+{
+}
+
+void Samo::copyright()
+{
+	Logger::info("Samo - Protein Structure Alignment tool [Version %s]", m_version);
+	Logger::info("Copyright (C) ZHANGroup@APORC.ORG 2005-%s. All rights reserved.\n", m_year);
+}
+
+void Samo::usage()
+{
+	Logger::info("Usage 1: Samo [options ...] [{code|file}[:id[:start[:end]]] ...]\n");
+	Logger::info("  <code>  is the 4-character PDB assigned identifier");
+	Logger::info("  <file>  is the PDB filename");
+	Logger::info("  <id>    is the chain identifier in the PDB file");
+	Logger::info("  <start> is the start residue sequence number");
+	Logger::info("  <end>   is the end residue sequence number");
+	Logger::info("");
+	Logger::info("Usage 2: Samo -pocket [options ...] [file[:pid[:cid]] ...]\n");
+	Logger::info("  <file>  is the Pocket filename");
+	Logger::info("  <pid>   is the pocket identifier in the Pocket file");
+	Logger::info("  <cid>   is the chain identifier in the Pocket file");
+	Logger::info("");
+	if (Logger::log_level() >= Logger::log_level_info()) {
+		cout << m_visible_options << "\n\n";
+	}
+	Logger::info("Examples:");
+	Logger::info("\tSamo 1dhf:a 8dfr");
+	Logger::info("\tSamo pdb1dhf.ent:a pdb8dfr.ent");
+	Logger::info("\tSamo 1dhf:a:20:120 8dfr:_:50:150");
+	Logger::info("\tSamo --extract --chain-db pdb.cdb 1dhf:a 8dfr");
+	Logger::info("\tSamo --chain-db pdb.cdb 1dhf:a:20:120 8dfr");
+}
+
+void Samo::printOptions()
+{
+	cout << "Used options (user specified):" << endl;
+	print_options(m_args, cout, DisplayOption::specified);
+	cout << "Used options (default):" << endl;
+	print_options(m_args, cout, DisplayOption::defaulted);
+	cout << endl;
+}
+
+void Samo::parseOptions()
+{
+	Logger::setLogLevel(m_args["debug"].as<int>());
+	if (!m_args.count("nologo")) {
+		copyright();
+	}
+	if (m_args.count("help") || !m_filenames.size()) {
+		usage();
+		exit(0);
+	}
+	if (Logger::isDebug()) {
+		printOptions();
+	}
+	if (m_params.validate && !m_params.single_precision) {
+		Logger::error("Validation checks the single precision result, please add --single-precision!");
+		exit(1);
+	}
+}
+
+void Samo::run()
+{
+	int i;
+	string filename;
+
+	if (m_args.count("extract")) {
+		for (i=0; i<m_chain_num; i++) {
+			Logger::info("Length of the protein chain %s is %d", m_chains[i].name(), m_chains[i].length());
+		}
+		if (m_args.count("chain-db")) filename = m_args["chain-db"].as<string>();
+		else filename = "Samo.cdb";
+		ChainDB::writeFile(filename, m_chains);
+		Logger::info("%d protein chains are written to the chain database %s", m_chain_num, filename.c_str());
+	}
+	else if (m_args.count("evaluate")) {
+		if (m_chain_num != 2) {
+			Logger::error("2 protein chains are required for evaluation!");
+			exit(1);
+		}
+		PairAlign palign(&m_chains[0], &m_chains[1]);
+		palign.setParams(m_params);
+		palign.evaluate(m_args["evaluate"].as<string>());
+		palign.postProcess();
+		output(palign);
+	}
+	else if (m_args.count("improve")) {
+		if (m_chain_num != 2) {
+			Logger::error("2 protein chains are required for improvement!");
+			exit(1);
+		}
+		PairAlign palign(&m_chains[0], &m_chains[1]);
+		palign.setParams(m_params);
+		palign.improve(m_args["improve"].as<string>());
+		palign.postProcess();
+		output(palign);
+	}
+	else if (m_args.count("benchmark")) {
+		if (m_chain_num != 2) {
+			Logger::error("2 protein chains are required for benchmark!");
+			exit(1);
+		}
+		PairAlign palign(&m_chains[0], &m_chains[1]);
+		palign.setParams(m_params);
+		palign.benchmark(m_args["benchmark"].as<int>());
+	}
+	else if (m_chain_num <= 1) {
+		Logger::error("At least 2 protein chains are required for alignment!");
+		exit(1);
+	}
+	else if (m_chain_num == 2) {
+		Logger::beginTimer(1, "Pairwise alignment");
+		PairAlign palign(&m_chains[0], &m_chains[1]);
+		palign.setParams(m_params);
+		palign.align();
+		palign.postProcess();
+		Logger::endTimer(1);
+		output(palign);
+	}
+	else {
+		Logger::beginTimer(1, "Multiple alignment");
+		MultiAlign malign(m_chain_num);
+		malign.setParams(m_params);
+		for (i=0; i<m_chain_num; i++) {
+			malign.setChain(i, &m_chains[i]);
+		}
+		malign.align();
+		Logger::endTimer(1);
+		output(malign);
+	}
+}
+
+void Samo::parseFileNames()
+{
+	int i, start, end;
+	string filename;
+	vector<string> tokens;
+	PDBFilter filter;
+
+	m_chain_num = m_filenames.size();
+	m_pdbs.resize(m_chain_num);
+	m_chains.resize(m_chain_num);
+
+	if (m_args.count("chain-db") && !m_args.count("extract") && !m_args.count("pocket")) {
+		parseChainNames();
+	}
+	else if (!m_args.count("pocket")) {
+		for (i=0; i<m_chain_num; i++) {
+			m_chains[i].setRawName(m_filenames[i]);
+			string_tokenize(tokens, m_filenames[i], ":");
+			filename = tokens[0];
+			if (filename.find('.') == string::npos) {
+				filename += ".ent";
+				if (filename.compare(0, 3, "pdb") != 0) {
+					filename = "pdb" + filename;
+				}
+				// large entries are only distributed as mmCIF, named by the code
+				filename = findFile(filename, filename.substr(3, filename.size() - 7) + ".cif");
+			}
+			m_chains[i].setPDB(&m_pdbs[i]);
+			if (tokens.size() > 1) {
+				if (tokens[1][0] != '#') parseChainID(i, tokens[1]);
+				if (tokens.size() > 2 && m_args.count("extract")) {
+					// the chain database keeps whole chains, ranges are given when loading
+					Logger::warning("Residue range of %s is ignored, whole chains are extracted!", m_filenames[i].c_str());
+				}
+				else if (tokens.size() > 2) {
+					start = str2int(tokens[2]);
+					if (tokens.size() > 3) end = str2int(tokens[3]);
+					else end = 0;
+					m_chains[i].setRange(start, end);
+				}
+			}
+			// only the atoms of the chain are read, the chain given by its index
+			// is known once the file is read
+			filter = m_chains[i].getFilter();
+			if (tokens.size() > 1 && tokens[1][0] == '#') filter.chain_index = str2int(tokens[1].substr(1));
+			m_pdbs[i].readFile(filename, &filter);
+			if (tokens.size() > 1 && tokens[1][0] == '#') parseChainID(i, tokens[1]);
+			m_chains[i].getChain();
+			if (m_chains[i].length() == 0) exit(1);
+		}
+	}
+	else {
+		for (i=0; i<m_chain_num; i++) {
+			m_chains[i].setRawName(m_filenames[i]);
+			string_tokenize(tokens, m_filenames[i], ":");
+			filename = tokens[0];
+			if (filename.find('.') == string::npos) {
+				filename += ".poc";
+// 				if (filename.compare(0, 3, "pdb") != 0) {
+// 					filename = "pdb" + filename;
+// 				}
+				filename = findFile(filename);
+			}
+			m_pdbs[i].readPocket(filename);
+			m_chains[i].setPDB(&m_pdbs[i]);
+			if (tokens.size() > 1) {
+				parsePocketID(i, tokens[1]);
+				if (tokens.size() > 2) parseChainID(i, tokens[2]);
+			}
+			m_chains[i].getPocketChain();
+			if (m_chains[i].length() == 0) exit(1);
+		}
+	}
+}
+
+// chains given by code as for PDB files, loaded from the chain database, where
+// the chain given by its index is counted in order of the PDB file
+
+void Samo::parseChainNames()
+{
+	int i, k, start, end, chain_index;
+	char chain_id;
+	vector<string> tokens;
+
+	if (!m_chain_db.open(m_args["chain-db"].as<string>())) {
+		Logger::error("Can not read the chain database: %s!", m_args["chain-db"].as<string>().c_str());
+		exit(1);
+	}
+	for (i=0; i<m_chain_num; i++) {
+		m_chains[i].setRawName(m_filenames[i]);
+		string_tokenize(tokens, m_filenames[i], ":");
+		chain_id = 0;
+		chain_index = 1;
+		if (tokens.size() > 1) {
+			if (tokens[1][0] == '#') chain_index = str2int(tokens[1].substr(1));
+			else chain_id = tokens[1][0];
+			if (tokens.size() > 2) {
+				start = str2int(tokens[2]);
+				if (tokens.size() > 3) end = str2int(tokens[3]);
+				else end = 0;
+				m_chains[i].setRange(start, end);
+			}
+		}
+		if ((k = m_chain_db.find(tokens[0], chain_id, chain_index)) < 0) {
+			Logger::error("Can not find chain %s in the chain database %s!", m_filenames[i].c_str(), m_chain_db.filename());
+			exit(1);
+		}
+		m_chain_db.getChain(k, m_chains[i]);
+		if (m_chains[i].length() == 0) exit(1);
+	}
+}
+
+// the first existing file of the name, its gzip version as mirrors of PDB keep
+// it, and the same for the alternative name, or the name itself if none exists
+
+string Samo::findFile(const string &filename, const string &alternative)
+{
+	string names[4];
+	FILE *fp;
+	int i;
+	names[0] = filename;
+	names[1] = filename + ".gz";
+	names[2] = alternative;
+	names[3] = alternative + ".gz";
+	for (i=0; i<4; i++) {
+		if (names[i].empty() || names[i] == ".gz") continue;
+		if ((fp = fopen(names[i].c_str(), "rb")) != NULL) {
+			fclose(fp);
+			return names[i];
+		}
+	}
+	return filename;
+}
+
+void Samo::parsePocketID(int i, const string &token)
+{
+	if (token[0] == '#') {
+		m_chains[i].setPocketID(m_pdbs[i].getPocketID(str2int(token.substr(1))));
+	}
+	else {
+		m_chains[i].setPocketID(str2int(token));
+	}
+}
+
+void Samo::parseChainID(int i, const string &token)
+{
+	if (token[0] == '#') {
+		m_chains[i].setChainID(m_pdbs[i].getChainID(str2int(token.substr(1))));
+	}
+	else {
+		m_chains[i].setChainID(token[0]);
+	}
 }
\ No newline at end of file
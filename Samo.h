@@ -1,65 +1,69 @@
-
-#ifndef __SAMO_H
-#define __SAMO_H
-
-
-#include <boost/program_options.hpp>
-
-#include "Utils.h"
-#include "PDB.h"
-#include "ProteinChain.h"
-#include "PairAlign.h"
-#include "MultiAlign.h"
-
-
-namespace po = ::boost::program_options;
-
-
-class Samo {
-	po::options_description m_options;
-	po::options_description m_visible_options;
-	po::variables_map m_args;
-
-	int m_chain_num;
-	vector<string> m_filenames;
-	vector<PDB> m_pdbs;
-	vector<ProteinChain> m_chains;
-
-	AlignParams m_params;
-
-	static const char *m_version;
-	static const char *m_year;
-
-public:
-	Samo(int argc = 0, char *argv[] = NULL);
-	~Samo();
-
-	void copyright();
-	void usage();
-	void printOptions();
-	void parseOptions();
-
-	void run();
-
-	template<class A>
-	void output(const A &align);
-
-	void parseFileNames();
-	void parseChainID(int i, const string &token);
-	void parsePocketID(int i, const string &token);
-};
-
-
-template<class A>
-void Samo::output(const A &align)
-{
-	if (m_args.count("output-solution")) {
-		align.writeSolutionFile(m_args["output-solution"].as<string>());
-	}
-	if (m_args.count("output-pdb")) {
-		align.writePDBFile(m_args["output-pdb"].as<string>());
-	}
-}
-
-
-#endif // __SAMO_H
+
+#ifndef __SAMO_H
+#define __SAMO_H
+
+
+#include <boost/program_options.hpp>
+
+#include "Utils.h"
+#include "PDB.h"
+#include "ProteinChain.h"
+#include "ChainDB.h"
+#include "PairAlign.h"
+#include "MultiAlign.h"
+
+
+namespace po = ::boost::program_options;
+
+
+class Samo {
+	po::options_description m_options;
+	po::options_description m_visible_options;
+	po::variables_map m_args;
+
+	int m_chain_num;
+	vector<string> m_filenames;
+	vector<PDB> m_pdbs;
+	vector<ProteinChain> m_chains;
+	ChainDB m_chain_db;
+
+	AlignParams m_params;
+
+	static const char *m_version;
+	static const char *m_year;
+
+public:
+	Samo(int argc = 0, char *argv[] = NULL);
+	~Samo();
+
+	void copyright();
+	void usage();
+	void printOptions();
+	void parseOptions();
+
+	void run();
+
+	template<class A>
+	void output(const A &align);
+
+	void parseFileNames();
+	void parseChainNames();
+	void parseChainID(int i, const string &token);
+	void parsePocketID(int i, const string &token);
+	static string findFile(const string &filename, const string &alternative = string());
+};
+
+
+template<class A>
+void Samo::output(const A &align)
+{
+	if (m_args.count("output-solution")) {
+		align.writeSolutionFile(m_args["output-solution"].as<string>());
+	}
+	if (m_args.count("output-pdb")) {
+		align.writePDBFile(m_args["output-pdb"].as<string>());
+	}
+}
+
+
+#endif // __SAMO_H
@@ -0,0 +1,136 @@
+#include <cmath>
+#include <algorithm>
+
+#include "Utils.h"
+#include "SpatialGrid.h"
+
+#include "MemLeak.h"
+
+
+////////////////////////////////
+//
+// class SpatialGrid
+
+SpatialGrid::SpatialGrid()
+{
+	int i;
+	m_cell_size = 1.0;
+	for (i=0; i<3; i++) {
+		m_origin[i] = 0;
+		m_dim[i] = 0;
+	}
+}
+
+void SpatialGrid::build(const double *x, const double *y, const double *z, int n, double radius)
+{
+	const double *coords[3];
+	double point[3], lower[3], upper[3], cells;
+	int cell[3];
+	int i, k, c;
+
+	m_cell_start.clear();
+	m_points.clear();
+	m_coords.clear();
+	for (k=0; k<3; k++) m_dim[k] = 0;
+	if (n <= 0) return;
+
+	coords[0] = x;
+	coords[1] = y;
+	coords[2] = z;
+	for (k=0; k<3; k++) {
+		lower[k] = upper[k] = coords[k][0];
+		for (i=1; i<n; i++) {
+			lower[k] = min(lower[k], coords[k][i]);
+			upper[k] = max(upper[k], coords[k][i]);
+		}
+	}
+
+	// cells are never smaller than the query radius, and are enlarged until
+	// there are not many more cells than points, the cells are counted in
+	// double as far apart points would overflow an int
+	m_cell_size = max(radius, 1e-3);
+	while (true) {
+		cells = 1;
+		for (k=0; k<3; k++) {
+			cells *= floor((upper[k] - lower[k]) / m_cell_size) + 1;
+		}
+		if (cells <= 4.0 * n + 64) break;
+		m_cell_size *= 1.5;
+	}
+	c = (int) cells;
+	for (k=0; k<3; k++) {
+		m_dim[k] = (int) ((upper[k] - lower[k]) / m_cell_size) + 1;
+		m_origin[k] = lower[k];
+	}
+
+	// counting sort of points by cell
+	m_cell_index.resize(n);
+	m_cell_start.assign(c+1, 0);
+	for (i=0; i<n; i++) {
+		for (k=0; k<3; k++) {
+			point[k] = coords[k][i];
+		}
+		m_cell_index[i] = _getCell(point, cell);
+		m_cell_start[m_cell_index[i]+1]++;
+	}
+	for (c=0; c<(int) m_cell_start.size()-1; c++) {
+		m_cell_start[c+1] += m_cell_start[c];
+	}
+	m_points.resize(n);
+	m_coords.resize(3*n);
+	for (i=0; i<n; i++) {
+		c = m_cell_start[m_cell_index[i]]++;
+		m_points[c] = i;
+		for (k=0; k<3; k++) {
+			m_coords[3*c+k] = coords[k][i];
+		}
+	}
+	for (c=m_cell_start.size()-1; c>0; c--) {
+		m_cell_start[c] = m_cell_start[c-1];
+	}
+	m_cell_start[0] = 0;
+}
+
+// append indices and square distances of the points within radius of the given point
+
+void SpatialGrid::query(const double point[3], double radius, vector<int> &neighbors, vector<double> &distances) const
+{
+	double radius2, d, dist;
+	int cell[3], lower[3], upper[3];
+	int x, y, c, p, k;
+
+	if (m_points.empty()) return;
+	radius2 = radius * radius;
+	for (k=0; k<3; k++) {
+		cell[k] = (int) floor((point[k] - m_origin[k]) / m_cell_size);
+		lower[k] = max(cell[k] - 1, 0);
+		upper[k] = min(cell[k] + 1, m_dim[k] - 1);
+		if (lower[k] > upper[k]) return;
+	}
+	for (x=lower[0]; x<=upper[0]; x++) {
+		for (y=lower[1]; y<=upper[1]; y++) {
+			c = (x * m_dim[1] + y) * m_dim[2];
+			for (p=m_cell_start[c+lower[2]]; p<m_cell_start[c+upper[2]+1]; p++) {
+				dist = 0;
+				for (k=0; k<3; k++) {
+					d = m_coords[3*p+k] - point[k];
+					dist += d * d;
+				}
+				if (dist <= radius2) {
+					neighbors.push_back(m_points[p]);
+					distances.push_back(dist);
+				}
+			}
+		}
+	}
+}
+
+int SpatialGrid::_getCell(const double point[3], int cell[3]) const
+{
+	int k;
+	for (k=0; k<3; k++) {
+		cell[k] = (int) ((point[k] - m_origin[k]) / m_cell_size);
+		cell[k] = min(max(cell[k], 0), m_dim[k] - 1);
+	}
+	return (cell[0] * m_dim[1] + cell[1]) * m_dim[2] + cell[2];
+}
@@ -0,0 +1,39 @@
+#ifndef __SPATIALGRID_H
+#define __SPATIALGRID_H
+
+
+#include <vector>
+
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Uniform grid over a set of points for fixed-radius neighbor queries.
+// The cell size is at least the query radius, so a query only visits the 3x3x3
+// cells around the query point.  Points are stored sorted by cell, together with
+// a copy of their coordinates, so each cell is a contiguous range.
+/////////////////////////////////////////////////////////////////////////////////////
+
+
+class SpatialGrid {
+	double m_cell_size;
+	double m_origin[3];
+	int m_dim[3];
+	vector<int> m_cell_start;						// First point of each cell, plus end marker
+	vector<int> m_points;							// Original index of points sorted by cell
+	vector<double> m_coords;						// Coordinates of points sorted by cell
+	vector<int> m_cell_index;						// Cell of each point, used while building
+
+public:
+	SpatialGrid();
+
+	void build(const double *x, const double *y, const double *z, int n, double radius);
+	void query(const double point[3], double radius, vector<int> &neighbors, vector<double> &distances) const;
+
+	// every query visits all cells, so the grid saves no distance
+	bool dense() const { return m_dim[0] <= 3 && m_dim[1] <= 3 && m_dim[2] <= 3; }
+
+private:
+	int _getCell(const double point[3], int cell[3]) const;
+};
+
+
+#endif // __SPATIALGRID_H
@@ -0,0 +1,327 @@
+#include <cmath>
+#include <algorithm>
+
+#include "Utils.h"
+#include "Superposition.h"
+
+#include "MemLeak.h"
+
+
+static double det3(const double m[3][3])
+{
+	return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+		 - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+		 + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+// minor of the 4x4 matrix m without row r and column c
+
+static double minor4(const double m[4][4], int r, int c)
+{
+	double s[3][3];
+	int i, j, k, l;
+	for (i=0, k=0; i<4; i++) {
+		if (i == r) continue;
+		for (j=0, l=0; j<4; j++) {
+			if (j == c) continue;
+			s[k][l++] = m[i][j];
+		}
+		k++;
+	}
+	return det3(s);
+}
+
+// cyclic Jacobi method for the eigenvector of the largest eigenvalue of a
+// symmetric 4x4 matrix, used when the characteristic polynomial has a
+// multiple root and the adjugate vanishes
+
+static double jacobi4(const double matrix[4][4], double q[4])
+{
+	double m[4][4], v[4][4], theta, t, c, s, g, h;
+	int sweep, i, j, k, max_k;
+
+	for (i=0; i<4; i++) {
+		for (j=0; j<4; j++) {
+			m[i][j] = matrix[i][j];
+			v[i][j] = (i == j) ? 1.0 : 0.0;
+		}
+	}
+	for (sweep=0; sweep<50; sweep++) {
+		g = 0;
+		for (i=0; i<4; i++) {
+			for (j=i+1; j<4; j++) {
+				g += fabs(m[i][j]);
+			}
+		}
+		if (g < 1e-300) break;
+		for (i=0; i<4; i++) {
+			for (j=i+1; j<4; j++) {
+				if (m[i][j] == 0) continue;
+				theta = (m[j][j] - m[i][i]) / (2 * m[i][j]);
+				t = (theta >= 0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1));
+				c = 1 / sqrt(t * t + 1);
+				s = t * c;
+				for (k=0; k<4; k++) {
+					g = m[k][i];
+					h = m[k][j];
+					m[k][i] = c * g - s * h;
+					m[k][j] = s * g + c * h;
+				}
+				for (k=0; k<4; k++) {
+					g = m[i][k];
+					h = m[j][k];
+					m[i][k] = c * g - s * h;
+					m[j][k] = s * g + c * h;
+				}
+				for (k=0; k<4; k++) {
+					g = v[k][i];
+					h = v[k][j];
+					v[k][i] = c * g - s * h;
+					v[k][j] = s * g + c * h;
+				}
+			}
+		}
+	}
+	max_k = 0;
+	for (k=1; k<4; k++) {
+		if (m[k][k] > m[max_k][max_k]) max_k = k;
+	}
+	for (i=0; i<4; i++) {
+		q[i] = v[i][max_k];
+	}
+	return m[max_k][max_k];
+}
+
+
+////////////////////////////////
+//
+// class Superposition
+
+void Superposition::clear()
+{
+	int i, j;
+	m_num = 0;
+	m_norm = 0;
+	m_weight = 0;
+	m_wnorm = 0;
+	for (i=0; i<3; i++) {
+		m_origin_a[i] = m_origin_b[i] = 0;
+		m_sum_a[i] = m_sum_b[i] = 0;
+		m_wsum_a[i] = m_wsum_b[i] = 0;
+		for (j=0; j<3; j++) {
+			m_inner[i][j] = 0;
+			m_winner[i][j] = 0;
+		}
+	}
+}
+
+void Superposition::add(const double a[3], const double b[3], double weight)
+{
+	double x[3], y[3];
+	int i, j;
+	if (m_num == 0) {
+		for (i=0; i<3; i++) {
+			m_origin_a[i] = a[i];
+			m_origin_b[i] = b[i];
+		}
+	}
+	m_num++;
+	m_weight += weight;
+	for (i=0; i<3; i++) {
+		x[i] = a[i] - m_origin_a[i];
+		y[i] = b[i] - m_origin_b[i];
+	}
+	for (i=0; i<3; i++) {
+		m_sum_a[i] += x[i];
+		m_sum_b[i] += y[i];
+		m_wsum_a[i] += weight * x[i];
+		m_wsum_b[i] += weight * y[i];
+		m_norm += x[i] * x[i] + y[i] * y[i];
+		m_wnorm += weight * (x[i] * x[i] + y[i] * y[i]);
+		for (j=0; j<3; j++) {
+			m_inner[i][j] += x[i] * y[j];
+			m_winner[i][j] += weight * x[i] * y[j];
+		}
+	}
+}
+
+// Solve the weighted superposition, pairs without weights are superposed evenly.
+// The largest eigenvalue of Horn's 4x4 key matrix is found by Newton's method on
+// its characteristic polynomial, starting from the upper bound (|a|^2 + |b|^2) / 2,
+// and the rotation quaternion is the largest column of the adjugate of
+// (K - lambda I). Returns false in the degenerate case, where a reflection fits
+// clearly better than any rotation.
+
+bool Superposition::solve(double translation[3], double rotation[3][3], double *wrmsd) const
+{
+	double center_a[3], center_b[3], s[3][3], k[4][4], adj[4][4], q[4];
+	double norm, lambda, c0, c1, c2, p, dp, delta, det, inv2, len, max_len;
+	const double *sum_a, *sum_b, (*inner)[3];
+	double weight;
+	int i, j, iter, max_j;
+
+	if (m_weight > 0) {
+		weight = m_weight;
+		sum_a = m_wsum_a;
+		sum_b = m_wsum_b;
+		norm = m_wnorm;
+		inner = m_winner;
+	}
+	else {
+		weight = m_num;
+		sum_a = m_sum_a;
+		sum_b = m_sum_b;
+		norm = m_norm;
+		inner = m_inner;
+	}
+	if (weight <= 0) {
+		for (i=0; i<3; i++) {
+			translation[i] = 0;
+			for (j=0; j<3; j++) {
+				rotation[i][j] = (i == j) ? 1.0 : 0.0;
+			}
+		}
+		if (wrmsd != NULL) *wrmsd = 0;
+		return false;
+	}
+
+	for (i=0; i<3; i++) {
+		center_a[i] = sum_a[i] / weight;
+		center_b[i] = sum_b[i] / weight;
+		norm -= center_a[i] * sum_a[i] + center_b[i] * sum_b[i];
+	}
+	for (i=0; i<3; i++) {
+		for (j=0; j<3; j++) {
+			s[i][j] = inner[i][j] - center_a[i] * sum_b[j];
+		}
+	}
+
+	k[0][0] = s[0][0] + s[1][1] + s[2][2];
+	k[0][1] = s[1][2] - s[2][1];
+	k[0][2] = s[2][0] - s[0][2];
+	k[0][3] = s[0][1] - s[1][0];
+	k[1][1] = s[0][0] - s[1][1] - s[2][2];
+	k[1][2] = s[0][1] + s[1][0];
+	k[1][3] = s[2][0] + s[0][2];
+	k[2][2] = - s[0][0] + s[1][1] - s[2][2];
+	k[2][3] = s[1][2] + s[2][1];
+	k[3][3] = - s[0][0] - s[1][1] + s[2][2];
+	for (i=0; i<4; i++) {
+		for (j=0; j<i; j++) {
+			k[i][j] = k[j][i];
+		}
+	}
+
+	// characteristic polynomial x^4 + c2 x^2 + c1 x + c0 of the traceless K
+	c2 = 0;
+	inv2 = 0;
+	for (i=0; i<3; i++) {
+		for (j=0; j<3; j++) {
+			c2 += s[i][j] * s[i][j];
+		}
+	}
+	det = det3(s);
+	c1 = -8 * det;
+	c0 = 0;
+	for (j=0; j<4; j++) {
+		c0 += ((j % 2) ? -1 : 1) * k[0][j] * minor4(k, 0, j);
+	}
+	// second invariant of S'S, the sum of products of two squared singular values
+	for (i=0; i<3; i++) {
+		for (j=0; j<3; j++) {
+			inv2 -= (s[0][i] * s[0][j] + s[1][i] * s[1][j] + s[2][i] * s[2][j])
+				  * (s[0][i] * s[0][j] + s[1][i] * s[1][j] + s[2][i] * s[2][j]);
+		}
+	}
+	inv2 = (c2 * c2 + inv2) / 2;
+	c2 *= -2;
+
+	lambda = norm / 2;
+	for (iter=0; iter<50; iter++) {
+		p = ((lambda * lambda + c2) * lambda + c1) * lambda + c0;
+		dp = (4 * lambda * lambda + 2 * c2) * lambda + c1;
+		if (dp == 0) break;
+		delta = p / dp;
+		lambda -= delta;
+		if (fabs(delta) <= 1e-11 * fabs(lambda)) break;
+	}
+
+	for (i=0; i<4; i++) {
+		k[i][i] -= lambda;
+	}
+	max_len = 0;
+	max_j = 0;
+	for (j=0; j<4; j++) {
+		len = 0;
+		for (i=0; i<4; i++) {
+			adj[i][j] = (((i + j) % 2) ? -1 : 1) * minor4(k, j, i);
+			len += adj[i][j] * adj[i][j];
+		}
+		if (len > max_len) {
+			max_len = len;
+			max_j = j;
+		}
+	}
+	if (max_len > 1e-20 * pow(max(fabs(lambda), 1e-100), 6)) {
+		len = sqrt(max_len);
+		for (i=0; i<4; i++) {
+			q[i] = adj[i][max_j] / len;
+		}
+	}
+	else {
+		for (i=0; i<4; i++) {
+			k[i][i] += lambda;
+		}
+		lambda = jacobi4(k, q);
+	}
+
+	rotation[0][0] = q[0] * q[0] + q[1] * q[1] - q[2] * q[2] - q[3] * q[3];
+	rotation[0][1] = 2 * (q[1] * q[2] - q[0] * q[3]);
+	rotation[0][2] = 2 * (q[1] * q[3] + q[0] * q[2]);
+	rotation[1][0] = 2 * (q[1] * q[2] + q[0] * q[3]);
+	rotation[1][1] = q[0] * q[0] - q[1] * q[1] + q[2] * q[2] - q[3] * q[3];
+	rotation[1][2] = 2 * (q[2] * q[3] - q[0] * q[1]);
+	rotation[2][0] = 2 * (q[1] * q[3] - q[0] * q[2]);
+	rotation[2][1] = 2 * (q[2] * q[3] + q[0] * q[1]);
+	rotation[2][2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+	for (i=0; i<3; i++) {
+		translation[i] = center_b[i] + m_origin_b[i];
+		for (j=0; j<3; j++) {
+			translation[i] -= rotation[i][j] * (center_a[j] + m_origin_a[j]);
+		}
+	}
+
+	if (wrmsd != NULL) {
+		*wrmsd = sqrt(max(norm - 2 * lambda, 0.0) / weight);
+	}
+
+	// the smallest singular value is about |det| / sqrt(inv2) when it is small
+	if (det < 0 && det * det > 1e-12 * inv2) {
+		Logger::debug("Degenerate case, superposition by rotation fails!");
+		return false;
+	}
+	return true;
+}
+
+// unweighted RMSD of the pairs under a transformation
+
+double Superposition::rmsd(const double translation[3], const double rotation[3][3]) const
+{
+	double sum, ra, t;
+	int i, j;
+
+	if (m_num == 0) return 0;
+	sum = m_norm;
+	for (i=0; i<3; i++) {
+		// translation of the pairs around the origins
+		t = translation[i] - m_origin_b[i];
+		ra = 0;
+		for (j=0; j<3; j++) {
+			t += rotation[i][j] * m_origin_a[j];
+			ra += rotation[i][j] * m_sum_a[j];
+			sum -= 2 * rotation[i][j] * m_inner[j][i];
+		}
+		sum += t * (m_num * t + 2 * (ra - m_sum_b[i]));
+	}
+	return sqrt(max(sum, 0.0) / m_num);
+}
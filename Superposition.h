@@ -0,0 +1,41 @@
+#ifndef __SUPERPOSITION_H
+#define __SUPERPOSITION_H
+
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Least square superposition of point pairs (a, b), rotating a onto b.
+// Pairs are accumulated into first and second moments, both weighted and
+// unweighted, so the optimal weighted transformation is solved in closed form by
+// the quaternion characteristic polynomial (QCP) method, and the unweighted RMSD
+// of any transformation is computed without visiting the pairs again. Moments are
+// taken around the first pair to keep the sums small. A copy is cheap, so a
+// search adding one pair at a time keeps one per level instead of summing again.
+/////////////////////////////////////////////////////////////////////////////////////
+
+
+class Superposition {
+	int m_num;										// Number of pairs
+	double m_origin_a[3], m_origin_b[3];			// First pair, moments are taken around it
+	double m_sum_a[3], m_sum_b[3];					// Unweighted sums of coordinates
+	double m_norm;									// Unweighted sum of |a|^2 + |b|^2
+	double m_inner[3][3];							// Unweighted sums of a[i] * b[j]
+	double m_weight;								// Sum of weights
+	double m_wsum_a[3], m_wsum_b[3];				// Weighted sums of coordinates
+	double m_wnorm;									// Weighted sum of |a|^2 + |b|^2
+	double m_winner[3][3];							// Weighted sums of a[i] * b[j]
+
+public:
+	Superposition() { clear(); }
+
+	int num() const { return m_num; }
+	double weight() const { return m_weight; }
+
+	void clear();
+	void add(const double a[3], const double b[3], double weight = 1.0);
+
+	bool solve(double translation[3], double rotation[3][3], double *wrmsd = NULL) const;
+	double rmsd(const double translation[3], const double rotation[3][3]) const;
+};
+
+
+#endif // __SUPERPOSITION_H
@@ -0,0 +1,104 @@
+#include <boost/bind.hpp>
+
+#include "Utils.h"
+#include "ThreadPool.h"
+
+#include "MemLeak.h"
+
+
+////////////////////////////////
+//
+// class ThreadPool
+
+ThreadPool::ThreadPool(int thread_num)
+{
+	m_task_num = 0;
+	m_next_task = 0;
+	m_worker_num = 0;
+	m_running = 0;
+	m_round = 0;
+	m_stopping = false;
+	setThreadNum(thread_num);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		m_stopping = true;
+		m_started.notify_all();
+	}
+	m_threads.join_all();
+}
+
+void ThreadPool::setThreadNum(int thread_num)
+{
+	if (thread_num <= 0) {
+		thread_num = boost::thread::hardware_concurrency();
+	}
+	m_thread_num = max(thread_num, 1);
+}
+
+void ThreadPool::run(int task_num, const boost::function<void (int)> &task)
+{
+	int i;
+
+	if (m_thread_num <= 1 || task_num <= 1) {
+		for (i=0; i<task_num; i++) {
+			task(i);
+		}
+		return;
+	}
+
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		m_worker_num = min(m_thread_num, task_num) - 1;
+		for (i=m_threads.size(); i<m_worker_num; i++) {
+			m_threads.create_thread(boost::bind(&ThreadPool::_work, this, i, m_round));
+		}
+		m_task = task;
+		m_task_num = task_num;
+		m_next_task = 0;
+		m_running = m_worker_num;
+		m_round++;
+		m_started.notify_all();
+	}
+	while (_nextTask(i)) {
+		task(i);
+	}
+	{
+		boost::mutex::scoped_lock lock(m_mutex);
+		while (m_running > 0) m_finished.wait(lock);
+		m_task.clear();
+	}
+}
+
+// a thread waits for a run newer than the last one it has seen, and skips it
+// if the run needs fewer threads
+
+void ThreadPool::_work(int id, int round)
+{
+	int index;
+	while (true) {
+		{
+			boost::mutex::scoped_lock lock(m_mutex);
+			while (m_round == round && !m_stopping) m_started.wait(lock);
+			if (m_stopping) return;
+			round = m_round;
+			if (id >= m_worker_num) continue;
+		}
+		while (_nextTask(index)) {
+			m_task(index);
+		}
+		boost::mutex::scoped_lock lock(m_mutex);
+		if (--m_running == 0) m_finished.notify_all();
+	}
+}
+
+bool ThreadPool::_nextTask(int &index)
+{
+	boost::mutex::scoped_lock lock(m_mutex);
+	if (m_next_task >= m_task_num) return false;
+	index = m_next_task++;
+	return true;
+}
@@ -0,0 +1,47 @@
+#ifndef __THREADPOOL_H
+#define __THREADPOOL_H
+
+
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+
+// run a number of independent tasks on a fixed number of threads, the calling
+// thread takes tasks as well, and the other threads are started on the first
+// run and wait for the next one until the pool is destroyed, so that their
+// thread specific data is kept from run to run
+
+class ThreadPool {
+	int m_thread_num;
+	int m_task_num, m_next_task;
+	boost::function<void (int)> m_task;
+	boost::mutex m_mutex;
+	boost::thread_group m_threads;
+	int m_worker_num;								// Number of started threads taking part in this run
+	int m_running;									// Number of those still running tasks
+	int m_round;									// Number of runs, to wake the threads for a new one
+	bool m_stopping;
+	boost::condition_variable m_started, m_finished;
+
+public:
+	ThreadPool(int thread_num = 1);
+	~ThreadPool();
+
+	int thread_num() const { return m_thread_num; }
+
+	void setThreadNum(int thread_num);
+
+	void run(int task_num, const boost::function<void (int)> &task);
+
+private:
+	void _work(int id, int round);
+	bool _nextTask(int &index);
+
+	ThreadPool(const ThreadPool &);
+	ThreadPool &operator=(const ThreadPool &);
+};
+
+
+#endif // __THREADPOOL_H
@@ -1,241 +1,411 @@
-
-#include <cstdlib>
-#include <cstdarg>
-
-#include "Utils.h"
-
-
-////////////////////////////////
-//
-// class Timer
-
-
-int Timer::m_instance_num = 0;
-
-void Timer::begin(const char *description)
-{
-	m_running = true;
-	m_duration = 0;
-	strcpy(m_description, description);
-	Logger::debug("TIMER %d: %s ...", m_id, m_description);
-	m_start = clock();
-}
-
-void Timer::end()
-{
-	pause();
-	Logger::debug("TIMER %d: %s = %f seconds", m_id, m_description, m_duration);
-}
-
-void Timer::pause()
-{
-	if (m_running) {
-		m_finish = clock();
-		m_duration += (double) (m_finish - m_start) / CLOCKS_PER_SEC;
-		m_running = false;
-	}
-}
-
-void Timer::resume()
-{
-	if (!m_running) {
-		m_start = clock();
-		m_running = true;
-	}
-}
-
-
-////////////////////////////////
-//
-// class Logger
-
-
-bool Logger::m_logging = true;
-int Logger::m_log_level = 3;
-const int Logger::m_log_level_error = 1;
-const int Logger::m_log_level_warning = 2;
-const int Logger::m_log_level_info = 3;
-const int Logger::m_log_level_verbose = 4;
-const int Logger::m_log_level_debug = 5;
-Timer Logger::m_timer[10];
-
-void Logger::setLogLevel(int level)
-{
-	m_log_level = level;
-}
-
-void Logger::enableLogging()
-{
-	m_logging = true;
-}
-
-void Logger::disableLogging()
-{
-	m_logging = false;
-}
-
-void Logger::error(const char *format, ...)
-{
-	va_list argptr;
-	va_start(argptr, format);
-	_println(m_log_level_error, stderr, "ERROR: ", format, argptr);
-	va_end(argptr);
-}
-
-void Logger::warning(const char *format, ...)
-{
-	va_list argptr;
-	va_start(argptr, format);
-	_println(m_log_level_warning, stderr, "WARNING: ", format, argptr);
-	va_end(argptr);
-}
-
-void Logger::info(const char *format, ...)
-{
-	va_list argptr;
-	va_start(argptr, format);
-	_println(m_log_level_info, stdout, NULL, format, argptr);
-	va_end(argptr);
-}
-
-void Logger::verbose(const char *format, ...)
-{
-	va_list argptr;
-	va_start(argptr, format);
-	_println(m_log_level_verbose, stderr, NULL, format, argptr);
-	va_end(argptr);
-}
-
-void Logger::status(const char *format, ...)
-{
-	va_list argptr;
-	va_start(argptr, format);
-	_print(m_log_level_verbose, stderr, NULL, format, argptr);
-	print(m_log_level_verbose, stderr, NULL, "               \r");
-	va_end(argptr);
-}
-
-void Logger::debug(const char *format, ...)
-{
-	va_list argptr;
-	va_start(argptr, format);
-	_println(m_log_level_debug, stderr, NULL, format, argptr);
-	va_end(argptr);
-}
-
-void Logger::print(int level, FILE *fp, const char *prompt, const char *format, ...)
-{
-	va_list argptr;
-	va_start(argptr, format);
-	_print(level, stderr, NULL, format, argptr);
-	va_end(argptr);
-}
-
-void Logger::println(int level, FILE *fp, const char *prompt, const char *format, ...)
-{
-	va_list argptr;
-	va_start(argptr, format);
-	_println(level, stderr, NULL, format, argptr);
-	va_end(argptr);
-}
-
-inline void Logger::_print(int level, FILE *fp, const char *prompt, const char *format, va_list argptr)
-{
-	if (m_log_level >= level) {
-		if (prompt != NULL) fprintf(fp, prompt);
-		vfprintf(fp, format, argptr);
-	}
-}
-
-inline void Logger::_println(int level, FILE *fp, const char *prompt, const char *format, va_list argptr)
-{
-	if (m_log_level >= level) {
-		if (prompt != NULL) fprintf(fp, prompt);
-		vfprintf(fp, format, argptr);
-		fprintf(fp, "\n");
-	}
-}
-
-void Logger::beginTimer(int i, const char *description)
-{
-	m_timer[i].begin(description);
-}
-
-void Logger::endTimer(int i)
-{
-	m_timer[i].end();
-}
-
-void Logger::pauseTimer(int i)
-{
-	m_timer[i].pause();
-}
-
-void Logger::resumeTimer(int i)
-{
-	m_timer[i].resume();
-}
-
-
-////////////////////////////////
-//
-// functions for string
-
-void string_replace(string &str, const string &src, const string &dst)
-{
-	string::size_type npos = static_cast<string::size_type>(string::npos);
-	string::size_type pos = 0;
-	string::size_type srclen = src.size();
-	string::size_type dstlen = dst.size();
-	while((pos=str.find(src, pos)) != npos) {
-		str.replace(pos, srclen, dst);
-		pos += dstlen;
-	}
-}
-
-void string_tokenize(vector<string> &tokens, const string &str, const string &delimiters, bool empty_field)
-{
-	string::size_type begin = 0, end = 0;
-	tokens.clear();
-	while (begin != string::npos) {
-		end = str.find_first_of(delimiters, begin);
-		if (end == string::npos) {
-			tokens.push_back(str.substr(begin));
-			break;
-		}
-		else {
-			tokens.push_back(str.substr(begin, end-begin));
-			if (empty_field) {
-				begin = end + 1;
-			}
-			else {
-				begin = str.find_first_not_of(delimiters, end);
-			}
-		}
-	}
-} 
-
-string int2str(int num)
-{
-	if (num == 0) return "0";
-	string str = "";
-	int num_abs = num > 0 ? num : -num;
-	while (num_abs) {
-		str = static_cast<char>(num_abs % 10 + '0') + str;
-		num_abs /= 10;
-	}
-	if (num < 0) str = "-" + str;
-	return str;
-}
-
-int str2int(const string &str)
-{
-	int len = str.size(), num = 0, i = 0;
-    if (str[0] == '-') i = 1;
-	while (i < len) {
-		num = num * 10 + static_cast<int>(str[i] - '0');
-		++i;
-	}
-	if (str[0] == '-') num *= -1;
-	return num;
-}
+
+#include <cstdlib>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // _WIN32
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif // HAVE_ZLIB
+
+#include "Utils.h"
+
+
+////////////////////////////////
+//
+// class Timer
+
+
+int Timer::m_instance_num = 0;
+
+void Timer::begin(const char *description)
+{
+	m_running = true;
+	m_duration = 0;
+	strcpy(m_description, description);
+	Logger::debug("TIMER %d: %s ...", m_id, m_description);
+	m_start = clock();
+}
+
+void Timer::end()
+{
+	pause();
+	Logger::debug("TIMER %d: %s = %f seconds", m_id, m_description, m_duration);
+}
+
+void Timer::pause()
+{
+	if (m_running) {
+		m_finish = clock();
+		m_duration += (double) (m_finish - m_start) / CLOCKS_PER_SEC;
+		m_running = false;
+	}
+}
+
+void Timer::resume()
+{
+	if (!m_running) {
+		m_start = clock();
+		m_running = true;
+	}
+}
+
+
+////////////////////////////////
+//
+// class Logger
+
+
+bool Logger::m_logging = true;
+int Logger::m_log_level = 3;
+const int Logger::m_log_level_error = 1;
+const int Logger::m_log_level_warning = 2;
+const int Logger::m_log_level_info = 3;
+const int Logger::m_log_level_verbose = 4;
+const int Logger::m_log_level_debug = 5;
+Timer Logger::m_timer[10];
+
+void Logger::setLogLevel(int level)
+{
+	m_log_level = level;
+}
+
+void Logger::enableLogging()
+{
+	m_logging = true;
+}
+
+void Logger::disableLogging()
+{
+	m_logging = false;
+}
+
+void Logger::error(const char *format, ...)
+{
+	va_list argptr;
+	va_start(argptr, format);
+	_println(m_log_level_error, stderr, "ERROR: ", format, argptr);
+	va_end(argptr);
+}
+
+void Logger::warning(const char *format, ...)
+{
+	va_list argptr;
+	va_start(argptr, format);
+	_println(m_log_level_warning, stderr, "WARNING: ", format, argptr);
+	va_end(argptr);
+}
+
+void Logger::info(const char *format, ...)
+{
+	va_list argptr;
+	va_start(argptr, format);
+	_println(m_log_level_info, stdout, NULL, format, argptr);
+	va_end(argptr);
+}
+
+void Logger::verbose(const char *format, ...)
+{
+	va_list argptr;
+	va_start(argptr, format);
+	_println(m_log_level_verbose, stderr, NULL, format, argptr);
+	va_end(argptr);
+}
+
+void Logger::status(const char *format, ...)
+{
+	va_list argptr;
+	va_start(argptr, format);
+	_print(m_log_level_verbose, stderr, NULL, format, argptr);
+	print(m_log_level_verbose, stderr, NULL, "               \r");
+	va_end(argptr);
+}
+
+void Logger::debug(const char *format, ...)
+{
+	va_list argptr;
+	va_start(argptr, format);
+	_println(m_log_level_debug, stderr, NULL, format, argptr);
+	va_end(argptr);
+}
+
+void Logger::print(int level, FILE *fp, const char *prompt, const char *format, ...)
+{
+	va_list argptr;
+	va_start(argptr, format);
+	_print(level, stderr, NULL, format, argptr);
+	va_end(argptr);
+}
+
+void Logger::println(int level, FILE *fp, const char *prompt, const char *format, ...)
+{
+	va_list argptr;
+	va_start(argptr, format);
+	_println(level, stderr, NULL, format, argptr);
+	va_end(argptr);
+}
+
+inline void Logger::_print(int level, FILE *fp, const char *prompt, const char *format, va_list argptr)
+{
+	if (m_log_level >= level) {
+		if (prompt != NULL) fprintf(fp, prompt);
+		vfprintf(fp, format, argptr);
+	}
+}
+
+inline void Logger::_println(int level, FILE *fp, const char *prompt, const char *format, va_list argptr)
+{
+	if (m_log_level >= level) {
+		if (prompt != NULL) fprintf(fp, prompt);
+		vfprintf(fp, format, argptr);
+		fprintf(fp, "\n");
+	}
+}
+
+void Logger::beginTimer(int i, const char *description)
+{
+	m_timer[i].begin(description);
+}
+
+void Logger::endTimer(int i)
+{
+	m_timer[i].end();
+}
+
+void Logger::pauseTimer(int i)
+{
+	m_timer[i].pause();
+}
+
+void Logger::resumeTimer(int i)
+{
+	m_timer[i].resume();
+}
+
+
+////////////////////////////////
+//
+// class MappedFile
+
+
+bool MappedFile::open(const char *filename, size_t window)
+{
+	close();
+	m_filename = filename;
+#ifndef _WIN32
+	struct stat st;
+	int fd;
+	if ((fd = ::open(filename, O_RDONLY)) < 0) return false;
+	if (fstat(fd, &st) < 0) {
+		::close(fd);
+		return false;
+	}
+	m_map_size = st.st_size;
+	if (m_map_size > 0) {
+		m_map = mmap(NULL, m_map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (m_map == MAP_FAILED) m_map = NULL;
+	}
+	::close(fd);
+	if (m_map != NULL) {
+		madvise(m_map, m_map_size, MADV_SEQUENTIAL);
+		m_data = (const char *) m_map;
+		m_size = m_map_size;
+		return _inflate(window);
+	}
+#endif // _WIN32
+	// no mapping, e.g. an empty file or a pipe, so the file is read instead
+	FILE *fp;
+	char buffer[65536];
+	size_t n;
+	if ((fp = fopen(filename, "rb")) == NULL) return false;
+	m_file.clear();
+	while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+		m_file.insert(m_file.end(), buffer, buffer + n);
+	}
+	fclose(fp);
+	m_size = m_file.size();
+	m_data = m_file.empty() ? "" : &m_file[0];
+	return _inflate(window);
+}
+
+// move the window of gzip data on, the data from keep on is moved to its front
+// and the rest is inflated, keep then points to the same data in the window,
+// returns false if nothing is left to read
+
+bool MappedFile::more(const char *&keep)
+{
+#ifdef HAVE_ZLIB
+	z_stream *stream = (z_stream *) m_stream;
+	size_t n, start, i;
+	int ret;
+
+	if (stream == NULL) return false;
+	// the window grows if the kept data fills more than half of it
+	n = m_data + m_size - keep;
+	memmove(&m_buffer[0], keep, n);
+	if (2 * n > m_buffer.size()) m_buffer.resize(2 * m_buffer.size());
+	m_data = keep = &m_buffer[0];
+	start = n;
+	while (n < m_buffer.size()) {
+		stream->next_in = (Bytef *) m_in;
+		stream->avail_in = (uInt) min(m_in_size, (size_t) 1 << 30);
+		stream->next_out = (Bytef *) &m_buffer[n];
+		stream->avail_out = (uInt) min(m_buffer.size() - n, (size_t) 1 << 30);
+		ret = inflate(stream, Z_NO_FLUSH);
+		n = (char *) stream->next_out - &m_buffer[0];
+		m_in_size -= (const char *) stream->next_in - m_in;
+		m_in = (const char *) stream->next_in;
+		if (ret == Z_STREAM_END) {
+			// concatenated members are read one by one, and other data after the
+			// last member is ignored as by gzip, silently if it is zero padding
+			if (m_in_size >= 2 && (unsigned char) m_in[0] == 0x1f && (unsigned char) m_in[1] == 0x8b) {
+				inflateReset(stream);
+				continue;
+			}
+			for (i=0; i<m_in_size && m_in[i] == 0; i++);
+			if (i < m_in_size) Logger::warning("Trailing garbage of gzip file %s is ignored!", m_filename.c_str());
+			_endInflate();
+			break;
+		}
+		if (ret != Z_OK) {
+			Logger::error("Corrupted gzip data in file %s!", m_filename.c_str());
+			exit(1);
+		}
+	}
+	m_size = n;
+	return (n > start);
+#else
+	return false;
+#endif // HAVE_ZLIB
+}
+
+// start to inflate gzip data into the window, or into a buffer that grows
+// until it holds the whole file if the window is 0
+
+bool MappedFile::_inflate(size_t window)
+{
+	if (m_size < 2 || (unsigned char) m_data[0] != 0x1f || (unsigned char) m_data[1] != 0x8b) return true;
+#ifdef HAVE_ZLIB
+	z_stream *stream;
+	const char *keep;
+
+	stream = new z_stream;
+	stream->zalloc = Z_NULL;
+	stream->zfree = Z_NULL;
+	stream->opaque = Z_NULL;
+	stream->next_in = Z_NULL;
+	stream->avail_in = 0;
+	if (inflateInit2(stream, 16 + MAX_WBITS) != Z_OK) {
+		delete stream;
+		return false;
+	}
+	m_stream = stream;
+	m_in = m_data;
+	m_in_size = m_size;
+	// PDB files compress about four times
+	m_buffer.resize((window > 0) ? window : max(4 * m_size, (size_t) 65536));
+	m_data = keep = &m_buffer[0];
+	m_size = 0;
+	while (more(keep) && window == 0);
+	return true;
+#else
+	Logger::error("Compressed input requires zlib, please rebuild with HAVE_ZLIB!");
+	return false;
+#endif // HAVE_ZLIB
+}
+
+void MappedFile::_endInflate()
+{
+#ifdef HAVE_ZLIB
+	if (m_stream != NULL) {
+		inflateEnd((z_stream *) m_stream);
+		delete (z_stream *) m_stream;
+	}
+#endif // HAVE_ZLIB
+	m_stream = NULL;
+	m_in = NULL;
+	m_in_size = 0;
+}
+
+void MappedFile::close()
+{
+	_endInflate();
+#ifndef _WIN32
+	if (m_map != NULL) munmap(m_map, m_map_size);
+#endif // _WIN32
+	m_map = NULL;
+	m_map_size = 0;
+	m_data = NULL;
+	m_size = 0;
+	vector<char>().swap(m_file);
+	vector<char>().swap(m_buffer);
+}
+
+
+////////////////////////////////
+//
+// functions for string
+
+void string_replace(string &str, const string &src, const string &dst)
+{
+	string::size_type npos = static_cast<string::size_type>(string::npos);
+	string::size_type pos = 0;
+	string::size_type srclen = src.size();
+	string::size_type dstlen = dst.size();
+	while((pos=str.find(src, pos)) != npos) {
+		str.replace(pos, srclen, dst);
+		pos += dstlen;
+	}
+}
+
+void string_tokenize(vector<string> &tokens, const string &str, const string &delimiters, bool empty_field)
+{
+	string::size_type begin = 0, end = 0;
+	tokens.clear();
+	while (begin != string::npos) {
+		end = str.find_first_of(delimiters, begin);
+		if (end == string::npos) {
+			tokens.push_back(str.substr(begin));
+			break;
+		}
+		else {
+			tokens.push_back(str.substr(begin, end-begin));
+			if (empty_field) {
+				begin = end + 1;
+			}
+			else {
+				begin = str.find_first_not_of(delimiters, end);
+			}
+		}
+	}
+} 
+
+string int2str(int num)
+{
+	if (num == 0) return "0";
+	string str = "";
+	int num_abs = num > 0 ? num : -num;
+	while (num_abs) {
+		str = static_cast<char>(num_abs % 10 + '0') + str;
+		num_abs /= 10;
+	}
+	if (num < 0) str = "-" + str;
+	return str;
+}
+
+int str2int(const string &str)
+{
+	int len = str.size(), num = 0, i = 0;
+    if (str[0] == '-') i = 1;
+	while (i < len) {
+		num = num * 10 + static_cast<int>(str[i] - '0');
+		++i;
+	}
+	if (str[0] == '-') num *= -1;
+	return num;
+}
@@ -0,0 +1,149 @@
+#!/usr/bin/env python
+# Generates the fixtures in tests/data. The structures are random CA walks of
+# fixed seeds, so running it again gives the same files byte for byte.
+#
+#   pdb/   pdb1aaa.ent (chains A, B), pdb1xaa.ent (A of 1aaa rotated, noisy and
+#          cut by 8 residues), pdb1yaa.ent (A of 1aaa shifted by 8 residues)
+#   crlf/  the same files with CRLF line ends and no final newline
+#   gz/    the same files gzipped: 1aaa after 1.6 MB of REMARK lines, so the
+#          reading window moves, in two members split mid line, 1xaa with CRLF
+#          line ends, 1yaa followed by zero padding
+#   gz-tail/, gz-cut/
+#          1xaa followed by bytes that are not gzip data, and cut in half
+#   cif/   the same files as mmCIF: 1aaa plain, 1xaa gzipped with a text field
+#          of 1.2 MB and a loop of 1.2 MB ahead of the atoms, so the window
+#          moves and grows, 1yaa with the mirrored atoms of a second model
+#   cif-merged/, cif-long/
+#          1aaa with chain B named AB, and 1xaa with an atom whose coordinate
+#          is too long to read
+#
+# usage: python tests/gen_fixtures.py, from the source directory
+
+import gzip, io, math, os, random
+
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "data")
+RES = ["ALA", "GLY", "LEU", "SER", "VAL", "THR", "LYS", "GLU"]
+COLUMNS = ["group_PDB", "id", "type_symbol", "label_atom_id", "label_alt_id", "label_comp_id", "label_asym_id",
+    "label_entity_id", "label_seq_id", "pdbx_PDB_ins_code", "Cartn_x", "Cartn_y", "Cartn_z", "occupancy",
+    "B_iso_or_equiv", "auth_seq_id", "auth_comp_id", "auth_asym_id", "auth_atom_id", "pdbx_PDB_model_num"]
+
+# a self-avoiding walk of n CA atoms 3.8A apart
+def walk(n, seed):
+    random.seed(seed)
+    pts = [(0.0, 0.0, 0.0)]
+    d = (1, 0, 0)
+    for i in range(n - 1):
+        while True:
+            v = [random.gauss(0, 1) for _ in range(3)]
+            v = [a + 1.2 * b for a, b in zip(v, d)]
+            l = math.sqrt(sum(a * a for a in v))
+            v = [a / l for a in v]
+            p = tuple(a + 3.8 * b for a, b in zip(pts[-1], v))
+            if all(sum((a - b) ** 2 for a, b in zip(p, q)) > 16 for q in pts[-30:-2]):
+                break
+        d = v
+        pts.append(p)
+    return pts
+
+# the points rotated, moved and given gaussian noise, the last drop ones cut
+def rot(pts, seed, noise, drop=0):
+    random.seed(seed)
+    a, b, c = random.random() * 6, random.random() * 6, random.random() * 6
+    ca, sa, cb, sb, cc, sc = math.cos(a), math.sin(a), math.cos(b), math.sin(b), math.cos(c), math.sin(c)
+    out = []
+    for x, y, z in pts[:len(pts) - drop]:
+        x, y = ca * x - sa * y, sa * x + ca * y
+        y, z = cb * y - sb * z, sb * y + cb * z
+        x, z = cc * x - sc * z, sc * x + cc * z
+        out.append((x + random.gauss(0, noise) + 10, y + random.gauss(0, noise) - 5, z + random.gauss(0, noise) + 3))
+    return out
+
+# PDB text of the chains, with N, CA and C atoms per residue
+def pdb(code, chains):
+    lines = ["HEADER    %-40s%9s   %4s" % ("TEST PROTEIN", "01-JAN-09", code.upper())]
+    s = 1
+    for cid, pts in chains:
+        for i, p in enumerate(pts):
+            for nm, off in ((" N  ", -1.0), (" CA ", 0.0), (" C  ", 1.0)):
+                lines.append("ATOM  %5d %4s %3s %c%4d    %8.3f%8.3f%8.3f  1.00 20.00           %s"
+                    % (s, nm, RES[i % 8], cid, i + 1, p[0] + off, p[1], p[2], nm.strip()[0]))
+                s += 1
+        lines.append("TER")
+    lines.append("MASTER    %40s%5d" % ("", s - 1))
+    lines.append("END")
+    return "\n".join(lines) + "\n"
+
+# mmCIF text of the atoms of a PDB text, after a text field and quoted values
+# that look like items, and padding text lines and loop rows; mirrored rows of
+# a second model if model2, chains renamed by chains
+def cif(code, text, padding=0, model2=False, chains={}, extra=[]):
+    out = ["data_%s" % code.upper(), "#", "_entry.id   %s" % code.upper(),
+        "_struct_keywords.pdbx_keywords 'TEST PROTEIN'",
+        "_pdbx_database_status.recvd_initial_deposition_date 2009-01-01",
+        "_struct.title", ";A text field with _fake.name and", "loop_ inside"]
+    out += ["%-60s" % "padding of the text field"] * padding
+    out += [";", "#", "loop_", "_other.a", "_other.b", "x 'quoted _v'", "y \"z w\""]
+    out += ["pad 'padding of the window'"] * padding
+    out += ["#", "loop_"] + ["_atom_site." + c for c in COLUMNS]
+    for model in (1, 2):
+        if model == 2 and not model2:
+            break
+        for l in text.splitlines():
+            if not l.startswith("ATOM  "):
+                continue
+            name = l[12:16].strip()
+            x, y, z = [float(l[k:k + 8]) for k in (30, 38, 46)]
+            if model == 2:
+                x = -x
+            chain = chains.get(l[21], l[21])
+            out.append(" ".join(["ATOM", l[6:11].strip(), name[0], name, ".", l[17:20], "X", "1", ".", "?",
+                "%.3f" % x, "%.3f" % y, "%.3f" % z, "1.00", "0.00", l[22:26].strip(), l[17:20], chain,
+                '"%s"' % name, str(model)]))
+    out += extra + ["#", "_end.x 1"]
+    return "\n".join(out) + "\n"
+
+# a gzip member of the data, with no name or time so it is reproducible
+def gz(data):
+    buf = io.BytesIO()
+    f = gzip.GzipFile(filename="", mode="wb", fileobj=buf, mtime=0)
+    f.write(data.encode("ascii"))
+    f.close()
+    return buf.getvalue()
+
+def write(path, data):
+    if not os.path.isdir(os.path.dirname(path)):
+        os.makedirs(os.path.dirname(path))
+    f = open(path, "wb")
+    f.write(data.encode("ascii") if not isinstance(data, bytes) else data)
+    f.close()
+
+def structures():
+    p = walk(80, 80)
+    a = pdb("1aaa", [("A", p), ("B", walk(40, 87))])
+    x = pdb("1xaa", [("A", rot(p, 81, 0.3, drop=8))])
+    random.seed(5)
+    y = pdb("1yaa", [("A", rot(p[8:], 83, 0.8))])
+    return {"1aaa": a, "1xaa": x, "1yaa": y}
+
+def main():
+    files = structures()
+    for code in sorted(files):
+        write(os.path.join(DATA, "pdb", "pdb%s.ent" % code), files[code])
+        write(os.path.join(DATA, "crlf", "pdb%s.ent" % code), files[code].rstrip("\n").replace("\n", "\r\n"))
+
+    a = "REMARK 999 %69s\n" % "" * 20000 + files["1aaa"]
+    write(os.path.join(DATA, "gz", "pdb1aaa.ent.gz"), gz(a[:len(a) - 5000]) + gz(a[len(a) - 5000:]))
+    write(os.path.join(DATA, "gz", "pdb1xaa.ent.gz"), gz(files["1xaa"].replace("\n", "\r\n")))
+    write(os.path.join(DATA, "gz", "pdb1yaa.ent.gz"), gz(files["1yaa"]) + b"\0" * 1024)
+    x = gz(files["1xaa"])
+    write(os.path.join(DATA, "gz-tail", "pdb1xaa.ent.gz"), x + b"not gzip data\n")
+    write(os.path.join(DATA, "gz-cut", "pdb1xaa.ent.gz"), x[:len(x) // 2])
+
+    write(os.path.join(DATA, "cif", "1aaa.cif"), cif("1aaa", files["1aaa"]))
+    write(os.path.join(DATA, "cif", "1xaa.cif.gz"), gz(cif("1xaa", files["1xaa"], padding=20000)))
+    write(os.path.join(DATA, "cif", "1yaa.cif"), cif("1yaa", files["1yaa"], model2=True))
+    write(os.path.join(DATA, "cif-merged", "1aaa.cif"), cif("1aaa", files["1aaa"], chains={"B": "AB"}))
+    long = "ATOM 999 O O . GLU X 1 . ? %s 0.000 0.000 1.00 0.00 72 GLU A O 1" % ("1" * 40)
+    write(os.path.join(DATA, "cif-long", "1xaa.cif"), cif("1xaa", files["1xaa"], extra=[long]))
+
+main()
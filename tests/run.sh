@@ -0,0 +1,208 @@
+#!/bin/sh
+#
+# Checks samo on the fixtures in tests/data, made by tests/gen_fixtures.py.
+#
+# The summaries of the cases below are compared with tests/expected, which
+# were recorded from the baseline build with the plain PDB files. Branch and
+# bound cases are the exception: the baseline read the weight of unaligned
+# residues out of bounds in solveLeastSquare, so they were recorded after that
+# was fixed. Every input format runs the same cases from its own directory,
+# so a file that is read differently shows up as a failed case. The PDB file
+# written for one pair is compared too, since it holds every atom field read.
+#
+# usage: sh tests/run.sh [samo], from the source directory, ./samo by default
+
+SAMO=${1:-./samo}
+case $SAMO in
+/*) ;;
+*) SAMO=`pwd`/$SAMO ;;
+esac
+TESTS=`cd \`dirname $0\` && pwd`
+TMP=${TMPDIR:-/tmp}/samo-test.$$
+rm -rf $TMP
+mkdir -p $TMP
+trap 'rm -rf $TMP' 0
+failed=0
+
+CASES='
+pair		1aaa:a 1xaa
+shift		1aaa:a 1yaa
+chains		1aaa:a 1aaa:b
+default		1aaa 1xaa
+index		1aaa:#2 1yaa
+range		1aaa:a:5:60 1yaa
+self		1xaa 1xaa
+seq			--sequential-order 1aaa:a 1yaa
+seqchains	--sequential-order 1aaa:a 1aaa:b
+anneal		--annealing 1aaa:a 1yaa
+bnb			-b 1aaa:a:1:9 1yaa:a:1:8
+bnbchains	-b 1aaa:b:1:9 1yaa:a:5:12
+multi		1aaa:a 1xaa 1yaa
+'
+
+pass()
+{
+	echo "ok    $1"
+}
+
+fail()
+{
+	echo "FAIL  $1"
+	failed=`expr $failed + 1`
+}
+
+# the alignment summaries of a run, without the scores of each start
+SUMMARY='^(PairAlign|PostAlign|Multiple)|^	(Aligned|Break)'
+
+summary()
+{
+	"$SAMO" --nologo "$@" 2>&1 | grep -E "$SUMMARY"
+}
+
+# runs all cases in a directory of fixtures with the given options
+cases()
+{
+	dir=$1
+	shift
+	opts="$*"
+	echo "$CASES" | while read name args; do
+		[ -z "$name" ] && continue
+		(cd $dir && summary "$@" $args) > $TMP/$name.out
+		if cmp -s $TMP/$name.out $TESTS/expected/$name.txt; then
+			pass "$name${opts:+ $opts} in `basename $dir`"
+		else
+			fail "$name${opts:+ $opts} in `basename $dir`"
+			diff $TESTS/expected/$name.txt $TMP/$name.out
+		fi
+	done > $TMP/cases.log
+	cat $TMP/cases.log
+	n=`grep -c '^FAIL' $TMP/cases.log`
+	failed=`expr $failed + $n`
+}
+
+# the PDB file written for a pair in a directory of fixtures, which holds
+# every field read from the atoms, matches the expected one
+output()
+{
+	dir=$1
+	rm -f $TMP/output.pdb
+	(cd $dir && "$SAMO" --nologo --output-pdb $TMP/output.pdb 1aaa:a 1xaa) > /dev/null 2>&1
+	if cmp -s $TMP/output.pdb $TESTS/expected/output.pdb; then
+		pass "output in `basename $dir`"
+	else
+		fail "output in `basename $dir`"
+	fi
+}
+
+# a case run in a directory matches its expected summary and warns with a
+# message matching the pattern
+warning()
+{
+	name=$1
+	dir=$2
+	pattern=$3
+	shift 3
+	(cd $dir && "$SAMO" --nologo "$@") > $TMP/warning.out 2>&1
+	grep -E "$SUMMARY" $TMP/warning.out > $TMP/warning.sum
+	if grep -q -E "$pattern" $TMP/warning.out && cmp -s $TMP/warning.sum $TESTS/expected/$name.txt; then
+		pass "$name in `basename $dir`"
+	else
+		fail "$name in `basename $dir`"
+		cat $TMP/warning.out
+	fi
+}
+
+# a run in a directory fails with a message matching the pattern
+error()
+{
+	name=$1
+	dir=$2
+	pattern=$3
+	shift 3
+	if (cd $dir && "$SAMO" --nologo "$@") > $TMP/error.out 2>&1; then
+		fail "$name"
+	elif grep -q -E "$pattern" $TMP/error.out; then
+		pass "$name"
+	else
+		fail "$name"
+		cat $TMP/error.out
+	fi
+}
+
+# the check of single precision against double precision in a directory of
+# fixtures finds no residue aligned differently in any case
+validate()
+{
+	dir=$1
+	echo "$CASES" | while read name args; do
+		[ -z "$name" ] && continue
+		(cd $dir && "$SAMO" --nologo --single-precision --validate $args) 2>&1 | grep '^Validate:'
+	done > $TMP/validate.out
+	if [ -s $TMP/validate.out ] && ! grep -v ' 0 residues aligned differently' $TMP/validate.out > /dev/null; then
+		pass "validate in `basename $dir`"
+	else
+		fail "validate in `basename $dir`"
+		cat $TMP/validate.out
+	fi
+}
+
+# a copy of the chain database with bytes written at an offset, given as
+# octal escapes of printf in native byte order
+corrupt()
+{
+	cp $TMP/db/test.cdb $TMP/$1.cdb
+	printf "$3" | dd of=$TMP/$1.cdb bs=1 seek=$2 conv=notrunc 2> /dev/null
+}
+
+# PDB files, plain and with CRLF line ends and no final newline
+cases $TESTS/data/pdb
+cases $TESTS/data/crlf
+cases $TESTS/data/pdb -t 3
+output $TESTS/data/pdb
+output $TESTS/data/crlf
+error missing $TESTS/data/pdb 'Can not open the file' 1zzz 1xaa
+
+# gzipped PDB files, found by code in place of missing plain files
+cases $TESTS/data/gz
+output $TESTS/data/gz
+warning self $TESTS/data/gz-tail 'Trailing garbage' 1xaa 1xaa
+error truncated $TESTS/data/gz-cut 'Corrupted gzip data' 1xaa 1xaa
+
+# mmCIF files, plain and gzipped, found by code in place of missing PDB files
+cases $TESTS/data/cif
+output $TESTS/data/cif
+warning self $TESTS/data/cif-long 'Invalid atom record' 1xaa 1xaa
+error merged $TESTS/data/cif-merged 'can not be told apart' 1aaa:a 1aaa:a
+
+# a chain database extracted from the PDB files, from which the cases read all
+# chains by code in a directory without PDB files
+mkdir $TMP/db
+(cd $TESTS/data/pdb && "$SAMO" --nologo --extract --chain-db $TMP/db/test.cdb 1aaa:a 1aaa:b 1xaa 1yaa) > $TMP/extract.out 2>&1
+cases $TMP/db --chain-db test.cdb
+
+# corrupt copies of it are rejected: an index offset that wraps around when the
+# index size is added, more chains than the file holds, and a record offset of
+# the first chain, 1aaa:a, that is not 8-byte aligned
+index=`od -A n -t u8 -j 16 -N 8 $TMP/db/test.cdb | tr -d ' '`
+corrupt offset 16 '\370\377\377\377\377\377\377\377'
+corrupt count 8 '\377\377\377\177'
+corrupt record `expr $index + 24` '\034'
+error offset $TMP/db 'Can not read the chain database' --chain-db $TMP/offset.cdb 1xaa 1xaa
+error count $TMP/db 'Can not read the chain database' --chain-db $TMP/count.cdb 1xaa 1xaa
+error record $TMP/db 'Invalid record of chain 1AAAA' --chain-db $TMP/record.cdb 1aaa:a 1xaa
+
+# the matching repaired from the previous round gives the same alignments as
+# solving each round from scratch
+cases $TESTS/data/pdb --warm-start false
+
+# single precision weights and scores give the same alignments
+cases $TESTS/data/pdb --single-precision
+validate $TESTS/data/pdb
+error precision $TESTS/data/pdb 'please add --single-precision' --validate 1aaa:a 1xaa
+
+# the linear memory method of the sequential alignment gives the same
+# alignments as the full table
+cases $TESTS/data/pdb --align-memory 0
+
+echo "$failed failed"
+[ $failed -eq 0 ]